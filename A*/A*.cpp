@@ -3,6 +3,36 @@
 #include <vector>
 #include <queue>
 #include <cmath>
+#include <list>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <deque>
+#include <sstream>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 const int SCREEN_WIDTH = 600;
 const int SCREEN_HEIGHT = 600;
@@ -16,243 +46,3091 @@ struct Node {
     double h; // Heuristic value (Manhattan distance to end node)
     double f; // Total cost (g + h)
 
-    // Operator for priority queue
+    // Operator for priority queue (ties go to the deeper node so open
+    // areas are crossed in a straight line instead of flooded)
     bool operator<(const Node& other) const {
-        return f > other.f;
+        return f > other.f || (f == other.f && g < other.g);
     }
 };
 
+// Chunked world storage for maps far larger than a dense grid can hold.
+// The world is split into TILE_SIZE x TILE_SIZE tiles. Tiles that are all
+// free or all blocked are stored implicitly in the tile directory; only mixed
+// tiles carry a bitmap. The store is memory-mapped and mixed tiles are paged
+// in on first touch, with an LRU bound on how many stay resident.
+//
+// File layout: TileStoreHeader, one uint64 directory entry per tile (row-major
+// over tiles; TILE_FREE, TILE_BLOCKED or the file offset of the tile bitmap),
+// then the bitmaps themselves (one bit per cell, row-major inside the tile).
+const int TILE_SIZE = 64;
+const int TILE_BYTES = TILE_SIZE * TILE_SIZE / 8;
+const uint32_t TILE_STORE_MAGIC = 0x31454c54; // "TLE1"
+const uint64_t TILE_FREE = 0;
+const uint64_t TILE_BLOCKED = 1;
+
+struct TileStoreHeader {
+    uint32_t magic;
+    uint32_t tileSize;
+    int32_t width;
+    int32_t height;
+};
+
+inline bool tileBit(const uint8_t* bits, int cx, int cy) {
+    int i = cy * TILE_SIZE + cx;
+    return (bits[i >> 3] >> (i & 7)) & 1;
+}
+
+inline void setTileBit(uint8_t* bits, int cx, int cy) {
+    int i = cy * TILE_SIZE + cx;
+    bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+}
+
+// Function to write a tile store. fillTile(tileX, tileY, bits) sets the bits
+// of blocked cells in one tile; cells past the map edge are always blocked.
+bool writeTileStore(const std::string& path, int width, int height,
+                    const std::function<void(int, int, std::vector<uint8_t>&)>& fillTile) {
+    std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not create tile store " << path << std::endl;
+        return false;
+    }
+
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    TileStoreHeader header = { TILE_STORE_MAGIC, (uint32_t)TILE_SIZE, width, height };
+    std::vector<uint64_t> directory((size_t)tilesX * tilesY, TILE_FREE);
+    uint64_t offset = sizeof(header) + directory.size() * sizeof(uint64_t);
+
+    // Bitmaps go after the directory, which is filled in once all tiles are known
+    out.seekp((std::streamoff)offset);
+
+    std::vector<uint8_t> bits(TILE_BYTES);
+    for (int ty = 0; ty < tilesY; ty++) {
+        for (int tx = 0; tx < tilesX; tx++) {
+            std::fill(bits.begin(), bits.end(), 0);
+            fillTile(tx, ty, bits);
+
+            for (int cy = 0; cy < TILE_SIZE; cy++) {
+                for (int cx = 0; cx < TILE_SIZE; cx++) {
+                    if (tx * TILE_SIZE + cx >= width || ty * TILE_SIZE + cy >= height) {
+                        setTileBit(bits.data(), cx, cy);
+                    }
+                }
+            }
+
+            bool allFree = std::all_of(bits.begin(), bits.end(), [](uint8_t b) { return b == 0; });
+            bool allBlocked = std::all_of(bits.begin(), bits.end(), [](uint8_t b) { return b == 0xFF; });
+            uint64_t& entry = directory[(size_t)ty * tilesX + tx];
+            if (allFree) {
+                entry = TILE_FREE;
+            }
+            else if (allBlocked) {
+                entry = TILE_BLOCKED;
+            }
+            else {
+                entry = offset;
+                out.write(reinterpret_cast<const char*>(bits.data()), TILE_BYTES);
+                offset += TILE_BYTES;
+            }
+        }
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(directory.data()), directory.size() * sizeof(uint64_t));
+    return out.good();
+}
+
+// Read-only view of a tile store with a bounded set of resident tiles
+class ChunkedGrid {
+public:
+    explicit ChunkedGrid(size_t maxResidentTiles)
+        : fd(-1), mapping(MAP_FAILED), mappingSize(0), directory(nullptr), tilesX(0),
+          maxResident(std::max<size_t>(maxResidentTiles, 1)),
+          lastTile(NO_TILE), lastBits(nullptr), pageInCount(0), evictionCount(0) {
+        header = TileStoreHeader();
+    }
+
+    ~ChunkedGrid() {
+        if (mapping != MAP_FAILED) {
+            munmap(mapping, mappingSize);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    ChunkedGrid(const ChunkedGrid&) = delete;
+    ChunkedGrid& operator=(const ChunkedGrid&) = delete;
+
+    bool open(const std::string& path) {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Could not open tile store " << path << std::endl;
+            return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TileStoreHeader)) {
+            std::cerr << "Tile store " << path << " is truncated" << std::endl;
+            return false;
+        }
+
+        mappingSize = (size_t)info.st_size;
+        mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Could not map tile store " << path << std::endl;
+            return false;
+        }
+        // Searches touch a thin corridor of tiles, so read-ahead is wasted
+        madvise(mapping, mappingSize, MADV_RANDOM);
+
+        header = *static_cast<const TileStoreHeader*>(mapping);
+        tilesX = (header.width + TILE_SIZE - 1) / TILE_SIZE;
+        int tilesY = (header.height + TILE_SIZE - 1) / TILE_SIZE;
+        size_t directoryEnd = sizeof(TileStoreHeader) + (size_t)tilesX * tilesY * sizeof(uint64_t);
+        if (header.magic != TILE_STORE_MAGIC || header.tileSize != (uint32_t)TILE_SIZE ||
+            header.width <= 0 || header.height <= 0 || directoryEnd > mappingSize) {
+            std::cerr << "Tile store " << path << " has an invalid header" << std::endl;
+            return false;
+        }
+
+        directory = reinterpret_cast<const uint64_t*>(static_cast<const char*>(mapping) + sizeof(TileStoreHeader));
+
+        // Every mixed tile must point at a whole bitmap past the directory
+        size_t tileCount = (size_t)tilesX * tilesY;
+        for (size_t tile = 0; tile < tileCount; tile++) {
+            uint64_t entry = directory[tile];
+            if (entry == TILE_FREE || entry == TILE_BLOCKED) {
+                continue;
+            }
+            if (entry < directoryEnd || entry > mappingSize || mappingSize - entry < (uint64_t)TILE_BYTES) {
+                std::cerr << "Tile store " << path << " has a directory entry outside its bitmap area" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    int width() const { return header.width; }
+    int height() const { return header.height; }
+
+    bool isBlocked(int x, int y) const {
+        uint64_t tile = (uint64_t)(y / TILE_SIZE) * tilesX + x / TILE_SIZE;
+        uint64_t entry = directory[tile];
+        if (entry == TILE_FREE) {
+            return false;
+        }
+        if (entry == TILE_BLOCKED) {
+            return true;
+        }
+        return tileBit(residentTile(tile, entry), x % TILE_SIZE, y % TILE_SIZE);
+    }
+
+    size_t pageIns() const { return pageInCount; }
+    size_t evictions() const { return evictionCount; }
+    size_t residentTiles() const { return resident.size(); }
+
+private:
+    static const uint64_t NO_TILE = ~(uint64_t)0;
+
+    struct ResidentTile {
+        std::list<uint64_t>::iterator lruPosition;
+        std::vector<uint8_t> bits;
+    };
+
+    // Returns the bitmap of a mixed tile, paging it in if needed
+    const uint8_t* residentTile(uint64_t tile, uint64_t offset) const {
+        if (tile == lastTile) {
+            return lastBits;
+        }
+
+        std::unordered_map<uint64_t, ResidentTile>::iterator it = resident.find(tile);
+        if (it != resident.end()) {
+            lru.splice(lru.begin(), lru, it->second.lruPosition);
+        }
+        else {
+            if (resident.size() >= maxResident) {
+                evict(lru.back());
+            }
+            lru.push_front(tile);
+            it = resident.insert(std::make_pair(tile, ResidentTile())).first;
+            it->second.lruPosition = lru.begin();
+            const uint8_t* source = static_cast<const uint8_t*>(mapping) + offset;
+            it->second.bits.assign(source, source + TILE_BYTES);
+            pageInCount++;
+        }
+
+        lastTile = tile;
+        lastBits = it->second.bits.data();
+        return lastBits;
+    }
+
+    void evict(uint64_t tile) const {
+        // Let the kernel drop the mapped pages behind the evicted tile too
+        uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+        uintptr_t begin = (uintptr_t)mapping + directory[tile];
+        uintptr_t pageBegin = begin & ~(pageSize - 1);
+        madvise(reinterpret_cast<void*>(pageBegin), begin + TILE_BYTES - pageBegin, MADV_DONTNEED);
+
+        resident.erase(tile);
+        lru.pop_back();
+        if (lastTile == tile) {
+            lastTile = NO_TILE;
+        }
+        evictionCount++;
+    }
+
+    int fd;
+    void* mapping;
+    size_t mappingSize;
+    TileStoreHeader header;
+    const uint64_t* directory;
+    int tilesX;
+    size_t maxResident;
+
+    mutable std::list<uint64_t> lru; // Most recently used tile at the front
+    mutable std::unordered_map<uint64_t, ResidentTile> resident;
+    mutable uint64_t lastTile;
+    mutable const uint8_t* lastBits;
+    mutable size_t pageInCount;
+    mutable size_t evictionCount;
+};
+
+// Function to load a map in the MovingAI benchmark format ("type", "height",
+// "width" and "map" header lines, then one text row per grid row). '.', 'G'
+// and 'S' are passable, everything else is blocked.
+bool loadMovingAIMap(const std::string& path, int& width, int& height, std::vector<uint8_t>& blocked) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Could not open map " << path << std::endl;
+        return false;
+    }
+
+    std::string word;
+    width = height = 0;
+    while (in >> word && word != "map") {
+        if (word == "height") {
+            in >> height;
+        }
+        else if (word == "width") {
+            in >> width;
+        }
+    }
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Map " << path << " has no valid size header" << std::endl;
+        return false;
+    }
+
+    blocked.assign((size_t)width * height, 1);
+    std::string row;
+    for (int y = 0; y < height && in >> row; y++) {
+        for (int x = 0; x < width && x < (int)row.size(); x++) {
+            char c = row[x];
+            blocked[(size_t)y * width + x] = (c == '.' || c == 'G' || c == 'S') ? 0 : 1;
+        }
+    }
+    return true;
+}
+
+// Procedural outdoor tile: mostly open ground, with the occasional building
+// (a fully blocked tile) and patches of rough terrain (scattered obstacles)
+void generateOutdoorTile(uint32_t seed, int tileX, int tileY, std::vector<uint8_t>& bits) {
+    std::mt19937 rng(seed ^ ((uint32_t)tileX * 73856093u) ^ ((uint32_t)tileY * 19349663u));
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    int kind = percent(rng);
+    if (kind < 1) {
+        std::fill(bits.begin(), bits.end(), 0xFF);
+    }
+    else if (kind < 4) {
+        for (int cy = 0; cy < TILE_SIZE; cy++) {
+            for (int cx = 0; cx < TILE_SIZE; cx++) {
+                if (percent(rng) < 10) {
+                    setTileBit(bits.data(), cx, cy);
+                }
+            }
+        }
+    }
+}
+
+// Cell layout shared by the grid and all per-cell search state, chosen at
+// build time. Row-major by default; -DCELL_LAYOUT_TILED stores 16x16 blocks
+// contiguously and -DCELL_LAYOUT_MORTON lays each of those blocks out in
+// Z-order, so vertical neighbours usually share a cache line or page instead
+// of sitting a full row apart. Both pad the map only to whole blocks.
+const int LAYOUT_BLOCK = 16;
+
+#if defined(CELL_LAYOUT_MORTON)
+const char* const CELL_LAYOUT_NAME = "morton";
+#elif defined(CELL_LAYOUT_TILED)
+const char* const CELL_LAYOUT_NAME = "tiled";
+#else
+const char* const CELL_LAYOUT_NAME = "row-major";
+#endif
+
+// Spreads the low 32 bits of v onto the even bit positions
+inline uint64_t spreadBits(uint64_t v) {
+    v &= 0xFFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+class CellLayout {
+public:
+    CellLayout(int width, int height) : width(width), height(height) {
+        blocksX = (width + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK;
+    }
+
+    size_t index(int x, int y) const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        size_t block = (size_t)((unsigned)y / LAYOUT_BLOCK) * blocksX + (unsigned)x / LAYOUT_BLOCK;
+#endif
+#if defined(CELL_LAYOUT_MORTON)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK +
+               (size_t)(spreadBits((unsigned)x % LAYOUT_BLOCK) | (spreadBits((unsigned)y % LAYOUT_BLOCK) << 1));
+#elif defined(CELL_LAYOUT_TILED)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK + ((unsigned)y % LAYOUT_BLOCK) * LAYOUT_BLOCK + (unsigned)x % LAYOUT_BLOCK;
+#else
+        return (size_t)y * width + x;
+#endif
+    }
+
+    // Number of slots to allocate (the blocked layouts pad the map to whole blocks)
+    size_t size() const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        return (size_t)blocksX * ((height + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK) * LAYOUT_BLOCK * LAYOUT_BLOCK;
+#else
+        return (size_t)width * height;
+#endif
+    }
+
+private:
+    int width, height;
+    int blocksX;
+};
+
+// Per-cell array stored in CellLayout order. Indexed [y][x] like a nested vector.
+template <typename T>
+class CellArray {
+public:
+    typedef typename std::vector<T>::reference Reference;
+    typedef typename std::vector<T>::const_reference ConstReference;
+
+    class Row {
+    public:
+        Row(CellArray& cells, int y) : cells(cells), y(y) {}
+        Reference operator[](int x) { return cells.at(x, y); }
+    private:
+        CellArray& cells;
+        int y;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const CellArray& cells, int y) : cells(cells), y(y) {}
+        ConstReference operator[](int x) const { return cells.at(x, y); }
+    private:
+        const CellArray& cells;
+        int y;
+    };
+
+    CellArray(int width, int height, const T& value) : layout(width, height), cells(layout.size(), value) {}
+
+    Reference at(int x, int y) { return cells[layout.index(x, y)]; }
+    ConstReference at(int x, int y) const { return cells[layout.index(x, y)]; }
+    Row operator[](int y) { return Row(*this, y); }
+    ConstRow operator[](int y) const { return ConstRow(*this, y); }
+
+    void fill(const T& value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    CellLayout layout;
+    std::vector<T> cells;
+};
+
 // SDL window and renderer
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
+SDL_Texture* gViewTexture = nullptr; // The grid is drawn into this one pixel at a time
+
+// Grid representation
+CellArray<uint8_t> grid(COLUMNS, ROWS, 0);
+
+// Start and end points
+Node start, end;
+
+// Size of the map shown by the visualizer (COLUMNS x ROWS unless --view loaded one)
+int mapColumns = COLUMNS;
+int mapRows = ROWS;
+
+// Downsampled summaries of the grid for drawing zoomed-out views. Level k
+// covers 2^k x 2^k blocks of cells and counts, per block, the hurdles, the
+// cells the search has visited and the cells on the path. Levels start at
+// MIP_FIRST_LEVEL (finer views draw cells directly) and end with a single
+// block. The counts follow the grid cell by cell through setGridCell().
+const int MIP_FIRST_LEVEL = 2;
+
+class MipPyramid {
+public:
+    // Builds every level from scratch for a grid of the given size
+    void build(const CellArray<uint8_t>& cells, int width, int height) {
+        levels.clear();
+        for (int shift = MIP_FIRST_LEVEL; ; shift++) {
+            Level level;
+            level.shift = shift;
+            level.width = ((width - 1) >> shift) + 1;
+            level.height = ((height - 1) >> shift) + 1;
+            level.counts.assign((size_t)level.width * level.height * CHANNELS, 0);
+            levels.push_back(level);
+            if (level.width == 1 && level.height == 1) {
+                break;
+            }
+        }
+
+        // The first level sums cells, each later one sums 2x2 blocks of the one below
+        Level& first = levels[0];
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                int channel = channelOf(cells.at(x, y));
+                if (channel >= 0) {
+                    first.counts[first.slot(x >> first.shift, y >> first.shift) + channel]++;
+                }
+            }
+        }
+        for (size_t i = 1; i < levels.size(); i++) {
+            const Level& below = levels[i - 1];
+            Level& level = levels[i];
+            for (int by = 0; by < below.height; by++) {
+                for (int bx = 0; bx < below.width; bx++) {
+                    for (int channel = 0; channel < CHANNELS; channel++) {
+                        level.counts[level.slot(bx >> 1, by >> 1) + channel] += below.counts[below.slot(bx, by) + channel];
+                    }
+                }
+            }
+        }
+        mapWidth = width;
+        mapHeight = height;
+    }
+
+    // Accounts for one cell changing from before to after
+    void update(int x, int y, uint8_t before, uint8_t after) {
+        int removed = channelOf(before);
+        int added = channelOf(after);
+        if (removed == added) {
+            return;
+        }
+        for (Level& level : levels) {
+            size_t slot = level.slot(x >> level.shift, y >> level.shift);
+            if (removed >= 0) {
+                level.counts[slot + removed]--;
+            }
+            if (added >= 0) {
+                level.counts[slot + added]++;
+            }
+        }
+    }
+
+    // Smallest level whose blocks are at least minCells cells wide
+    int levelFor(double minCells) const {
+        int level = 0;
+        while (level + 1 < (int)levels.size() && (double)(1 << levels[level].shift) < minCells) {
+            level++;
+        }
+        return level;
+    }
+
+    int shift(int level) const { return levels[level].shift; }
+
+    // ARGB colour of a block: green if the path crosses it, otherwise white
+    // shaded toward yellow by the visited share and toward brown by the hurdle share
+    uint32_t color(int level, int bx, int by) const {
+        const Level& summary = levels[level];
+        const uint32_t* counts = &summary.counts[summary.slot(bx, by)];
+        if (counts[PATH] != 0) {
+            return 0xFF00FF00;
+        }
+
+        int x0 = bx << summary.shift;
+        int y0 = by << summary.shift;
+        double cells = (double)(std::min(mapWidth, x0 + (1 << summary.shift)) - x0) *
+                       (std::min(mapHeight, y0 + (1 << summary.shift)) - y0);
+        double visited = counts[VISITED] / cells;
+        double blocked = counts[BLOCKED] / cells;
+
+        double r = 255, g = 255, b = 255 * (1 - visited); // Toward yellow (255, 255, 0)
+        r += (139 - r) * blocked;                         // Toward brown (139, 69, 19)
+        g += (69 - g) * blocked;
+        b += (19 - b) * blocked;
+        return 0xFF000000 | (uint32_t)r << 16 | (uint32_t)g << 8 | (uint32_t)b;
+    }
+
+private:
+    enum { BLOCKED, VISITED, PATH, CHANNELS };
+
+    struct Level {
+        int shift;
+        int width, height;             // In blocks
+        std::vector<uint32_t> counts;  // CHANNELS counts per block
+
+        size_t slot(int bx, int by) const { return ((size_t)by * width + bx) * CHANNELS; }
+    };
+
+    // Channel a grid value counts toward, or -1 for none (free cells, start, end)
+    static int channelOf(uint8_t value) {
+        return value == 1 ? BLOCKED : value == 4 ? VISITED : value == 5 ? PATH : -1;
+    }
+
+    std::vector<Level> levels;
+    int mapWidth, mapHeight;
+};
+
+MipPyramid gridPyramid;
+
+// Function to change one grid cell, keeping the pyramid in step
+void setGridCell(int x, int y, uint8_t value) {
+    uint8_t& cell = grid[y][x];
+    gridPyramid.update(x, y, cell, value);
+    cell = value;
+}
+
+// Pan and zoom state of the visualizer: the map position at the window's
+// top-left corner, in cells, and the size of a cell in pixels (below 1 when
+// zoomed out far enough to show the pyramid)
+struct Viewport {
+    double originX, originY;
+    double cellPixels;
+
+    int cellX(int pixelX) const { return (int)std::floor(originX + pixelX / cellPixels); }
+    int cellY(int pixelY) const { return (int)std::floor(originY + pixelY / cellPixels); }
+
+    // Zooms by factor keeping the cell under (pixelX, pixelY) in place. The
+    // whole map always fits at the widest zoom.
+    void zoom(int pixelX, int pixelY, double factor) {
+        double minPixels = std::min(std::min((double)SCREEN_WIDTH / mapColumns, (double)SCREEN_HEIGHT / mapRows),
+                                    (double)GRID_SIZE);
+        double anchorX = originX + pixelX / cellPixels;
+        double anchorY = originY + pixelY / cellPixels;
+        cellPixels = std::max(minPixels, std::min(cellPixels * factor, 4.0 * GRID_SIZE));
+        originX = anchorX - pixelX / cellPixels;
+        originY = anchorY - pixelY / cellPixels;
+    }
+
+    void pan(int pixelsX, int pixelsY) {
+        originX -= pixelsX / cellPixels;
+        originY -= pixelsY / cellPixels;
+    }
+};
+
+Viewport view = { 0, 0, GRID_SIZE };
+
+// Per-cell search bookkeeping
+struct CellRecord {
+    double g;           // Best known cost from the start node
+    int parentX, parentY; // Where the best path came from (-1 for the start)
+    bool closed;
+};
+
+inline CellRecord unseenCell() {
+    CellRecord record = { std::numeric_limits<double>::infinity(), -1, -1, false };
+    return record;
+}
+
+// Dense search state with one record per cell, for maps that fit in memory
+class DenseSearchState {
+public:
+    DenseSearchState(int width, int height) : cells(width, height, unseenCell()) {}
+
+    CellRecord& at(int x, int y) { return cells.at(x, y); }
+    void reset() { cells.fill(unseenCell()); }
+
+private:
+    CellArray<CellRecord> cells;
+};
+
+// Packed per-cell codes of BITS bits each (BITS divides 8), in CellLayout order
+template <int BITS>
+class PackedCellCodes {
+public:
+    PackedCellCodes(int width, int height) : layout(width, height), bytes((layout.size() * BITS + 7) / 8, 0) {}
+
+    unsigned get(int x, int y) const {
+        size_t bit = layout.index(x, y) * BITS;
+        return (bytes[bit >> 3] >> (bit & 7)) & MASK;
+    }
+
+    void set(int x, int y, unsigned code) {
+        size_t bit = layout.index(x, y) * BITS;
+        uint8_t& byte = bytes[bit >> 3];
+        byte = (uint8_t)((byte & ~(MASK << (bit & 7))) | (code << (bit & 7)));
+    }
+
+    void clear() { std::fill(bytes.begin(), bytes.end(), 0); }
+    size_t memoryBytes() const { return bytes.size(); }
+
+private:
+    static const unsigned MASK = (1u << BITS) - 1;
+
+    CellLayout layout;
+    std::vector<uint8_t> bytes;
+};
+
+// Compact search state: 3 bits per cell, a closed flag plus the 2-bit
+// direction of the move that reached the cell (an index into the neighbour
+// tables). Costs are integers and are not stored per cell at all; the open
+// list bucket a node comes out of gives its f, and g = f - h.
+class CompactSearchState {
+public:
+    CompactSearchState(int width, int height) : closed(width, height), parents(width, height) {}
+
+    bool isClosed(int x, int y) const { return closed.get(x, y) != 0; }
+    unsigned parentDirection(int x, int y) const { return parents.get(x, y); }
+
+    void close(int x, int y, unsigned direction) {
+        closed.set(x, y, 1);
+        parents.set(x, y, direction);
+    }
+
+    void reset() {
+        closed.clear();
+        parents.clear();
+    }
+
+    size_t memoryBytes() const { return closed.memoryBytes() + parents.memoryBytes(); }
+
+private:
+    PackedCellCodes<1> closed;
+    PackedCellCodes<2> parents;
+};
+
+// Open list for integer costs: one LIFO bucket per f value. With a consistent
+// heuristic f never decreases, so a cursor sweeps the buckets once, and LIFO
+// order breaks ties toward the most recently generated (deepest) node.
+// Entries are 4 bytes: the row-major cell id, with the parent direction in
+// the top two bits; the f key is implied by the bucket.
+const uint32_t COMPACT_CELL_MASK = (1u << 30) - 1;
+
+class BucketOpenList {
+public:
+    explicit BucketOpenList(uint32_t minF) : base(minF), cursor(0), count(0), peak(0) {}
+
+    void push(uint32_t f, uint32_t entry) {
+        size_t bucket = f - base;
+        if (bucket >= buckets.size()) {
+            buckets.resize(bucket + 1);
+        }
+        buckets[bucket].push_back(entry);
+        peak = std::max(peak, ++count);
+    }
+
+    uint32_t pop(uint32_t& f) {
+        while (buckets[cursor].empty()) {
+            std::vector<uint32_t>().swap(buckets[cursor]); // Release the drained bucket
+            cursor++;
+        }
+        uint32_t entry = buckets[cursor].back();
+        buckets[cursor].pop_back();
+        count--;
+        f = base + (uint32_t)cursor;
+        return entry;
+    }
+
+    bool empty() const { return count == 0; }
+    size_t peakSize() const { return peak; }
+
+private:
+    uint32_t base;
+    size_t cursor;
+    size_t count;
+    size_t peak;
+    std::vector<std::vector<uint32_t>> buckets;
+};
+
+// Dense in-memory map stored in the same cell layout as the search state
+class DenseMap {
+public:
+    DenseMap(int width, int height) : mapWidth(width), mapHeight(height), blocked(width, height, 0) {}
+
+    int width() const { return mapWidth; }
+    int height() const { return mapHeight; }
+    bool isBlocked(int x, int y) const { return blocked.at(x, y) != 0; }
+    void setBlocked(int x, int y, bool value) { blocked.at(x, y) = value ? 1 : 0; }
+
+private:
+    int mapWidth, mapHeight;
+    CellArray<uint8_t> blocked;
+};
+
+// Versioned copy-on-write map store. Each published version is an immutable
+// GridSnapshot: a table of TILE_SIZE x TILE_SIZE chunks (bits as in the tile
+// store, null for an all-free chunk). An edit copies the table plus only the
+// chunks it touches, then publishes the result with an atomic store, so
+// unchanged chunks are shared between versions. Readers pin a version with an
+// atomic load and never wait on the writer mutex; once pinned, a version is
+// searched without any locking for as long as they need. (libstdc++ guards
+// shared_ptr atomics with a brief internal lock, so the load itself is not
+// lock-free.) The reference counts play the part of an RCU grace period: a
+// chunk is freed once the last version using it is released.
+struct GridChunk {
+    uint8_t bits[TILE_BYTES];
+};
+
+struct CellEdit {
+    int x, y;
+    bool blocked;
+};
+
+class GridSnapshot {
+public:
+    GridSnapshot(int width, int height, uint64_t version)
+        : mapWidth(width), mapHeight(height), chunksX((width + TILE_SIZE - 1) / TILE_SIZE), mapVersion(version),
+          chunks((size_t)chunksX * ((height + TILE_SIZE - 1) / TILE_SIZE)) {}
+
+    int width() const { return mapWidth; }
+    int height() const { return mapHeight; }
+    uint64_t version() const { return mapVersion; }
+
+    bool isBlocked(int x, int y) const {
+        const GridChunk* chunk = chunks[(size_t)(y / TILE_SIZE) * chunksX + x / TILE_SIZE].get();
+        return chunk != nullptr && tileBit(chunk->bits, x % TILE_SIZE, y % TILE_SIZE);
+    }
+
+private:
+    friend class VersionedGrid;
+
+    int mapWidth, mapHeight;
+    int chunksX;
+    uint64_t mapVersion;
+    std::vector<std::shared_ptr<const GridChunk>> chunks;
+};
+
+class VersionedGrid {
+public:
+    // Starts at version 0, an all-free map
+    VersionedGrid(int width, int height) : current(std::make_shared<GridSnapshot>(width, height, 0)) {}
+
+    // Pins the latest version; it stays valid and unchanged while held
+    std::shared_ptr<const GridSnapshot> snapshot() const { return std::atomic_load(&current); }
+
+    // Publishes a batch of edits as one new version. Returns that version and
+    // counts the chunks that had to be copied in copiedChunks.
+    uint64_t publish(const std::vector<CellEdit>& edits, size_t& copiedChunks) {
+        std::lock_guard<std::mutex> lock(writeMutex); // Writers take turns; readers never wait on this
+        std::shared_ptr<const GridSnapshot> base = std::atomic_load(&current);
+        std::shared_ptr<GridSnapshot> next = std::make_shared<GridSnapshot>(*base);
+        next->mapVersion = base->mapVersion + 1;
+
+        // Chunks copied for this version, which the remaining edits may write in place
+        std::unordered_map<size_t, GridChunk*> copies;
+        for (const CellEdit& edit : edits) {
+            if (edit.x < 0 || edit.x >= next->mapWidth || edit.y < 0 || edit.y >= next->mapHeight ||
+                next->isBlocked(edit.x, edit.y) == edit.blocked) {
+                continue;
+            }
+
+            size_t index = (size_t)(edit.y / TILE_SIZE) * next->chunksX + edit.x / TILE_SIZE;
+            GridChunk*& copy = copies[index];
+            if (copy == nullptr) {
+                std::shared_ptr<GridChunk> chunk = std::make_shared<GridChunk>();
+                if (next->chunks[index]) {
+                    *chunk = *next->chunks[index];
+                }
+                else {
+                    std::memset(chunk->bits, 0, sizeof(chunk->bits));
+                }
+                copy = chunk.get();
+                next->chunks[index] = chunk;
+            }
+
+            int i = (edit.y % TILE_SIZE) * TILE_SIZE + edit.x % TILE_SIZE;
+            if (edit.blocked) {
+                copy->bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+            }
+            else {
+                copy->bits[i >> 3] &= (uint8_t)~(1 << (i & 7));
+            }
+        }
+
+        copiedChunks = copies.size();
+        if (copies.empty()) {
+            return base->mapVersion; // Nothing changed
+        }
+        std::shared_ptr<const GridSnapshot> published(next);
+        std::atomic_store(&current, published);
+        return next->mapVersion;
+    }
+
+    // Publishes a whole new map as the next version
+    uint64_t replace(const DenseMap& map) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        std::shared_ptr<GridSnapshot> next =
+            std::make_shared<GridSnapshot>(map.width(), map.height(), std::atomic_load(&current)->mapVersion + 1);
+        std::vector<std::shared_ptr<GridChunk>> filled(next->chunks.size());
+        for (int y = 0; y < map.height(); y++) {
+            for (int x = 0; x < map.width(); x++) {
+                if (!map.isBlocked(x, y)) {
+                    continue;
+                }
+                std::shared_ptr<GridChunk>& chunk = filled[(size_t)(y / TILE_SIZE) * next->chunksX + x / TILE_SIZE];
+                if (!chunk) {
+                    chunk = std::make_shared<GridChunk>();
+                    std::memset(chunk->bits, 0, sizeof(chunk->bits));
+                }
+                setTileBit(chunk->bits, x % TILE_SIZE, y % TILE_SIZE);
+            }
+        }
+        next->chunks.assign(filled.begin(), filled.end());
+
+        std::shared_ptr<const GridSnapshot> published(next);
+        std::atomic_store(&current, published);
+        return next->mapVersion;
+    }
+
+private:
+    std::mutex writeMutex;
+    std::shared_ptr<const GridSnapshot> current;
+};
+
+// Hurdles drawn in the visualizer. The grid only holds what is on screen;
+// searches run on a pinned version of this, so hurdles can be drawn while a
+// search is animating without changing the map under it.
+VersionedGrid screenObstacles(COLUMNS, ROWS);
+
+// Sparse search state holding only the cells a search has reached, so its
+// size follows the explored corridor rather than the map
+class SparseSearchState {
+public:
+    explicit SparseSearchState(int width) : width(width) {}
+
+    CellRecord& at(int x, int y) {
+        uint64_t key = (uint64_t)y * width + x;
+        return cells.insert(std::make_pair(key, unseenCell())).first->second;
+    }
+
+    size_t size() const { return cells.size(); }
+
+private:
+    uint64_t width;
+    std::unordered_map<uint64_t, CellRecord> cells;
+};
+
+// State variable to track input order
+enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_SEARCHING, INPUT_DONE };
+InputState currentState = INPUT_START;
+
+// Frame pacing for the visualizer. A running search advances in small steps
+// between frames: each frame gets as many steps as fit the time left after
+// rendering, using running estimates of the step and render cost, optionally
+// capped by an animation speed in steps per second.
+const double TARGET_FRAME_MS = 1000.0 / 60.0;
+const double FRAME_MARGIN_MS = 2.0; // Headroom for event handling and timer jitter
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double stepsPerSecond)
+        : stepsPerSecond(stepsPerSecond), stepCostMs(0.01), renderCostMs(2.0), allowance(0),
+          frameStart(SDL_GetPerformanceCounter()), lastSlice(0) {}
+
+    void beginFrame() { frameStart = SDL_GetPerformanceCounter(); }
+
+    // Runs step() until it returns false, the speed cap is reached or the
+    // frame's time budget is spent. Returns false once the search is over.
+    template <typename Step>
+    bool runSlice(Step step) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        double budgetMs = std::max(TARGET_FRAME_MS - renderCostMs - FRAME_MARGIN_MS, 1.0);
+        double maxSteps = budgetMs / stepCostMs + 1;
+        if (stepsPerSecond > 0) {
+            // Accumulate fractional steps so slow speeds still move every few frames
+            double elapsedMs = lastSlice == 0 ? TARGET_FRAME_MS : millisecondsSince(lastSlice);
+            allowance = std::min(allowance + stepsPerSecond * elapsedMs / 1000.0, stepsPerSecond * TARGET_FRAME_MS / 1000.0 + 1);
+            maxSteps = std::min(maxSteps, allowance);
+        }
+        lastSlice = begin;
+
+        long steps = 0;
+        bool running = true;
+        while (running && steps < (long)maxSteps) {
+            running = step();
+            steps++;
+            // The estimate can be off (e.g. the search hits a slow region), so also check the clock
+            if ((steps & 63) == 0 && millisecondsSince(begin) > budgetMs) {
+                break;
+            }
+        }
+
+        if (steps > 0) {
+            stepCostMs = std::max(0.8 * stepCostMs + 0.2 * millisecondsSince(begin) / steps, 1e-5);
+            allowance -= steps;
+        }
+        return running;
+    }
+
+    template <typename Render>
+    void render(Render draw) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        draw();
+        renderCostMs = 0.8 * renderCostMs + 0.2 * millisecondsSince(begin);
+    }
+
+    // Sleeps off whatever is left of the current frame
+    void endFrame() {
+        double leftMs = TARGET_FRAME_MS - millisecondsSince(frameStart);
+        if (leftMs >= 1) {
+            SDL_Delay((Uint32)leftMs);
+        }
+    }
+
+    // Forgets the speed allowance, e.g. when a new search starts
+    void restart() {
+        allowance = 0;
+        lastSlice = 0;
+    }
+
+    // Speed controls: 0 steps per second means as fast as the frame budget allows
+    void faster() { stepsPerSecond = stepsPerSecond > 0 ? stepsPerSecond * 2 : 0; }
+    void slower() { stepsPerSecond = stepsPerSecond > 0 ? std::max(stepsPerSecond / 2, 1.0) : 1000; }
+    void unlimited() { stepsPerSecond = 0; }
+
+private:
+    static double millisecondsSince(Uint64 start) {
+        return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    double stepsPerSecond;
+    double stepCostMs;
+    double renderCostMs;
+    double allowance;
+    Uint64 frameStart;
+    Uint64 lastSlice;
+};
+
+// Animation speed in search steps per second (one expansion per 50 ms, as before); 0 means unlimited
+const double ANIMATION_STEPS_PER_SECOND = 20;
+// Maps with more cells than this start unlimited, since a search there can
+// take millions of steps; + and - still bring the cap back
+const uint64_t ANIMATED_MAX_CELLS = 256 * 256;
+
+// Function to initialize SDL
+bool init() {
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    gWindow = SDL_CreateWindow("Pathfinding Visualization", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
+    if (gWindow == nullptr) {
+        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
+    if (gRenderer == nullptr) {
+        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    gViewTexture = SDL_CreateTexture(gRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (gViewTexture == nullptr) {
+        std::cerr << "Texture could not be created! SDL_Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Function to handle mouse clicks
+void handleMouseClick(SDL_Event& event) {
+    int mouseX, mouseY;
+    SDL_GetMouseState(&mouseX, &mouseY);
+
+    int gridX = view.cellX(mouseX);
+    int gridY = view.cellY(mouseY);
+
+    if (gridX >= 0 && gridX < mapColumns && gridY >= 0 && gridY < mapRows && event.button.button == SDL_BUTTON_LEFT) {
+        if (grid[gridY][gridX] == 1) {
+            return; // Start and end go on free cells
+        }
+        if (currentState == INPUT_START) {
+            start = { gridX, gridY, 0, 0, 0 };
+            setGridCell(gridX, gridY, 2);
+            currentState = INPUT_END;
+        }
+        else if (currentState == INPUT_END) {
+            end = { gridX, gridY, 0, 0, 0 };
+            setGridCell(gridX, gridY, 3);
+            currentState = INPUT_HURDLES;
+        }
+        else if (currentState == INPUT_HURDLES || currentState == INPUT_SEARCHING) {
+            // Left click sets hurdles (a running search keeps the version it started on)
+            if (grid[gridY][gridX] != 2 && grid[gridY][gridX] != 3) {
+                setGridCell(gridX, gridY, 1);
+                std::vector<CellEdit> edits(1, CellEdit { gridX, gridY, true });
+                size_t copiedChunks;
+                screenObstacles.publish(edits, copiedChunks);
+            }
+        }
+    }
+}
+
+// Function to draw the visible part of the map. Every window pixel is filled
+// from the cell under it or, once a pixel spans several cells, from the
+// smallest pyramid block covering a pixel, so the cost follows the window
+// size rather than the map size.
+void renderGrid() {
+    static const uint32_t CELL_COLORS[] = {
+        0xFFFFFFFF, // Free (white)
+        0xFF8B4513, // Hurdle (brown)
+        0xFF00FF00, // Start (green)
+        0xFFFF0000, // End (red)
+        0xFFFFFF00, // Expanded (yellow)
+        0xFF00FF00, // Path (green)
+    };
+    static std::vector<uint32_t> pixels(SCREEN_WIDTH * SCREEN_HEIGHT);
+    static std::vector<int> columns(SCREEN_WIDTH);
+
+    // Cells (or blocks) under each pixel column, -1 past the map edge
+    bool zoomedOut = view.cellPixels < 1;
+    int level = zoomedOut ? gridPyramid.levelFor(1 / view.cellPixels) : 0;
+    int shift = zoomedOut ? gridPyramid.shift(level) : 0;
+    for (int px = 0; px < SCREEN_WIDTH; px++) {
+        int x = view.cellX(px);
+        columns[px] = x >= 0 && x < mapColumns ? x >> shift : -1;
+    }
+
+    for (int py = 0; py < SCREEN_HEIGHT; py++) {
+        uint32_t* row = &pixels[(size_t)py * SCREEN_WIDTH];
+        int y = view.cellY(py);
+        if (y < 0 || y >= mapRows) {
+            std::fill(row, row + SCREEN_WIDTH, 0xFF000000);
+            continue;
+        }
+        for (int px = 0; px < SCREEN_WIDTH; px++) {
+            int x = columns[px];
+            if (x < 0) {
+                row[px] = 0xFF000000;
+            }
+            else if (zoomedOut) {
+                row[px] = gridPyramid.color(level, x, y >> shift);
+            }
+            else {
+                row[px] = CELL_COLORS[grid[y][x]];
+            }
+        }
+    }
+
+    SDL_UpdateTexture(gViewTexture, nullptr, pixels.data(), SCREEN_WIDTH * sizeof(uint32_t));
+    SDL_RenderCopy(gRenderer, gViewTexture, nullptr, nullptr);
+
+    // Keep the start and end visible at any zoom
+    int markerSize = std::max((int)view.cellPixels, 5);
+    const Node* markers[] = { &start, &end };
+    for (int i = 0; i < 2; i++) {
+        if ((i == 0 && currentState == INPUT_START) || (i == 1 && currentState <= INPUT_END)) {
+            continue;
+        }
+        int px = (int)((markers[i]->x - view.originX) * view.cellPixels);
+        int py = (int)((markers[i]->y - view.originY) * view.cellPixels);
+        SDL_SetRenderDrawColor(gRenderer, i == 0 ? 0 : 255, i == 0 ? 255 : 0, 0, 255);
+        SDL_Rect marker = { px, py, markerSize, markerSize };
+        SDL_RenderFillRect(gRenderer, &marker);
+    }
+}
+
+// Function to calculate the Manhattan distance heuristic
+double calculateManhattanDistance(const Node& a, const Node& b) {
+    return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+}
+
+// Resumable A* over any map exposing width(), height() and isBlocked(x, y),
+// with search state from DenseSearchState or SparseSearchState. Each step()
+// expands one node, so callers can run the search a slice at a time. With
+// useHeuristic false the search runs as plain Dijkstra.
+template <typename Map, typename State>
+class AStarSearch {
+public:
+    AStarSearch(const Map& map, State& state, const Node& from, const Node& to, bool useHeuristic = true)
+        : map(map), state(state), to(to), useHeuristic(useHeuristic), done(false), reached(false) {
+        // Add the start node to the open set
+        Node first = { from.x, from.y, 0, 0, 0 };
+        first.h = heuristic(from.x, from.y);
+        first.f = first.h;
+        state.at(from.x, from.y).g = 0;
+        openSet.push(first);
+    }
+
+    // Expands the next node and stores it in expanded. Returns false, without
+    // expanding anything, once the search is over.
+    bool step(Node& expanded) {
+        // Generate neighbors
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+
+        while (!done && !openSet.empty()) {
+            Node current = openSet.top();
+            openSet.pop();
+
+            CellRecord& record = state.at(current.x, current.y);
+            if (record.closed) {
+                continue; // Stale entry for a node already expanded more cheaply
+            }
+            record.closed = true;
+            expanded = current;
+
+            if (current.x == to.x && current.y == to.y) {
+                // Reached the end, reconstruct the path
+                int x = current.x;
+                int y = current.y;
+                while (x != -1) {
+                    Node step = { x, y, 0, 0, 0 };
+                    foundPath.push_back(step);
+                    const CellRecord& previous = state.at(x, y);
+                    x = previous.parentX;
+                    y = previous.parentY;
+                }
+                std::reverse(foundPath.begin(), foundPath.end());
+                done = reached = true;
+                return true;
+            }
+
+            for (int i = 0; i < 4; i++) {
+                int newX = current.x + dx[i];
+                int newY = current.y + dy[i];
+
+                // Check if the neighbor is within bounds and passable
+                if (newX < 0 || newX >= map.width() || newY < 0 || newY >= map.height() || map.isBlocked(newX, newY)) {
+                    continue;
+                }
+
+                CellRecord& neighborRecord = state.at(newX, newY);
+                double tentativeG = current.g + 1.0;
+                if (neighborRecord.closed || tentativeG >= neighborRecord.g) {
+                    continue;
+                }
+
+                // Keep track of where the neighbor came from
+                neighborRecord.g = tentativeG;
+                neighborRecord.parentX = current.x;
+                neighborRecord.parentY = current.y;
+
+                Node neighbor = { newX, newY, tentativeG, heuristic(newX, newY), 0 };
+                neighbor.f = neighbor.g + neighbor.h;
+                openSet.push(neighbor);
+            }
+            return true;
+        }
+
+        // Path not found
+        done = true;
+        return false;
+    }
+
+    bool finished() const { return done; }
+    bool found() const { return reached; }
+
+    // Cells from start to goal, inclusive, once found() is true
+    std::vector<Node>& path() { return foundPath; }
+
+private:
+    double heuristic(int x, int y) const {
+        return useHeuristic ? std::abs(x - to.x) + std::abs(y - to.y) : 0;
+    }
+
+    const Map& map;
+    State& state;
+    Node to;
+    bool useHeuristic;
+    bool done;
+    bool reached;
+    std::priority_queue<Node> openSet;
+    std::vector<Node> foundPath;
+};
+
+// Function to run an AStarSearch to completion. onExpand is called for each
+// node taken off the open list; on success path holds the cells from start to
+// goal, inclusive.
+template <typename Map, typename State, typename OnExpand>
+bool aStarSearch(const Map& map, State& state, const Node& from, const Node& to,
+                 std::vector<Node>& path, OnExpand onExpand, bool useHeuristic = true) {
+    AStarSearch<Map, State> search(map, state, from, to, useHeuristic);
+    Node expanded;
+    while (search.step(expanded)) {
+        onExpand(expanded);
+    }
+    path.swap(search.path());
+    return search.found();
+}
+
+// Whether a map is small enough for compact entries (30-bit cell ids)
+template <typename Map>
+bool fitsCompactSearch(const Map& map) {
+    return (uint64_t)map.width() * map.height() <= (uint64_t)COMPACT_CELL_MASK + 1;
+}
+
+// Compact A*: same interface as AStarSearch, but with integer costs, a bucketed
+// open list of 4-byte entries and CompactSearchState. A cell may sit in the
+// open list more than once; only its first (cheapest) pop is expanded.
+template <typename Map>
+class CompactAStarSearch {
+public:
+    CompactAStarSearch(const Map& map, CompactSearchState& state, const Node& from, const Node& to,
+                       bool useHeuristic = true)
+        : map(map), state(state), from(from), to(to), useHeuristic(useHeuristic), width((uint32_t)map.width()),
+          openSet(heuristic(from.x, from.y)), done(false), reached(false) {
+        openSet.push(heuristic(from.x, from.y), (uint32_t)from.y * width + from.x);
+    }
+
+    bool step(Node& expanded) {
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+
+        while (!done && !openSet.empty()) {
+            uint32_t f;
+            uint32_t entry = openSet.pop(f);
+            uint32_t cell = entry & COMPACT_CELL_MASK;
+            int x = (int)(cell % width);
+            int y = (int)(cell / width);
+
+            if (state.isClosed(x, y)) {
+                continue; // Reached more cheaply already
+            }
+            state.close(x, y, entry >> 30);
+
+            uint32_t h = heuristic(x, y);
+            uint32_t g = f - h;
+            Node current = { x, y, (double)g, (double)h, (double)f };
+            expanded = current;
+
+            if (x == to.x && y == to.y) {
+                // Walk the direction codes back to the start
+                while (x != from.x || y != from.y) {
+                    Node step = { x, y, 0, 0, 0 };
+                    foundPath.push_back(step);
+                    unsigned direction = state.parentDirection(x, y);
+                    x -= dx[direction];
+                    y -= dy[direction];
+                }
+                Node first = { from.x, from.y, 0, 0, 0 };
+                foundPath.push_back(first);
+                std::reverse(foundPath.begin(), foundPath.end());
+                done = reached = true;
+                return true;
+            }
+
+            for (unsigned i = 0; i < 4; i++) {
+                int newX = x + dx[i];
+                int newY = y + dy[i];
+
+                if (newX < 0 || newX >= map.width() || newY < 0 || newY >= map.height() ||
+                    map.isBlocked(newX, newY) || state.isClosed(newX, newY)) {
+                    continue;
+                }
+
+                openSet.push(g + 1 + heuristic(newX, newY), (i << 30) | ((uint32_t)newY * width + newX));
+            }
+            return true;
+        }
+
+        // Path not found
+        done = true;
+        return false;
+    }
+
+    bool finished() const { return done; }
+    bool found() const { return reached; }
+    std::vector<Node>& path() { return foundPath; }
+
+private:
+    uint32_t heuristic(int x, int y) const {
+        return useHeuristic ? (uint32_t)(std::abs(x - to.x) + std::abs(y - to.y)) : 0;
+    }
+
+    const Map& map;
+    CompactSearchState& state;
+    Node from, to;
+    bool useHeuristic;
+    uint32_t width;
+    BucketOpenList openSet;
+    bool done;
+    bool reached;
+    std::vector<Node> foundPath;
+};
+
+template <typename Map, typename OnExpand>
+bool compactAStarSearch(const Map& map, CompactSearchState& state, const Node& from, const Node& to,
+                        std::vector<Node>& path, OnExpand onExpand, bool useHeuristic = true) {
+    CompactAStarSearch<Map> search(map, state, from, to, useHeuristic);
+    Node expanded;
+    while (search.step(expanded)) {
+        onExpand(expanded);
+    }
+    path.swap(search.path());
+    return search.found();
+}
+
+// Search being animated by the visualizer. The dense state takes 24 bytes per
+// cell, so maps with more cells than SCREEN_DENSE_MAX_CELLS animate the compact
+// search at 3 bits per cell instead (build with -DCOMPACT_SEARCH to use it on
+// every map).
+const uint64_t SCREEN_DENSE_MAX_CELLS = (uint64_t)1 << 22;
+
+std::shared_ptr<const GridSnapshot> screenSnapshot; // Map version the search runs on
+std::unique_ptr<DenseSearchState> screenDenseState;
+std::unique_ptr<AStarSearch<GridSnapshot, DenseSearchState>> denseSearch;
+std::unique_ptr<CompactSearchState> screenCompactState;
+std::unique_ptr<CompactAStarSearch<GridSnapshot>> compactSearch;
+
+// Whether the visualizer animates the compact search on the current map
+bool useCompactScreenSearch() {
+#ifdef COMPACT_SEARCH
+    return true;
+#else
+    return (uint64_t)mapColumns * mapRows > SCREEN_DENSE_MAX_CELLS;
+#endif
+}
+
+// Function to start animating A* from start to end
+void startAStar() {
+    screenSnapshot = screenObstacles.snapshot();
+    if (useCompactScreenSearch()) {
+        screenCompactState.reset(new CompactSearchState(mapColumns, mapRows));
+        compactSearch.reset(new CompactAStarSearch<GridSnapshot>(*screenSnapshot, *screenCompactState, start, end));
+    }
+    else {
+        screenDenseState.reset(new DenseSearchState(mapColumns, mapRows));
+        denseSearch.reset(new AStarSearch<GridSnapshot, DenseSearchState>(*screenSnapshot, *screenDenseState, start, end));
+    }
+}
+
+// Function to advance the animated A* by one expansion. Returns false once it
+// has finished, after marking the result on the grid.
+bool stepAStar() {
+    Node current;
+    if (compactSearch ? compactSearch->step(current) : denseSearch->step(current)) {
+        if (grid[current.y][current.x] == 0) {
+            setGridCell(current.x, current.y, 4); // Mark expanded nodes as yellow
+        }
+        return true;
+    }
+
+    // Highlight the shortest path from start to end in green, under any
+    // hurdles drawn since the search started
+    for (const Node& step : compactSearch ? compactSearch->path() : denseSearch->path()) {
+        if (grid[step.y][step.x] != 1) {
+            setGridCell(step.x, step.y, 5);
+        }
+    }
+    setGridCell(start.x, start.y, 2); // Start in green
+    setGridCell(end.x, end.y, 3);     // End in red
+
+    bool found = compactSearch ? compactSearch->found() : denseSearch->found();
+    currentState = found ? INPUT_DONE : INPUT_HURDLES;
+    compactSearch.reset();
+    denseSearch.reset();
+    screenCompactState.reset();
+    screenDenseState.reset();
+    screenSnapshot.reset();
+    return false;
+}
+
+// Function to read "<in.map> | <width> <height>" map arguments starting at
+// argv[first]. Generated maps block obstaclePercent of the cells at random.
+// Returns the index of the first argument after the map, or 0 on error.
+int readMapArguments(int argc, char* argv[], int first, int obstaclePercent, std::unique_ptr<DenseMap>& map) {
+    if (first >= argc) {
+        return 0;
+    }
+    if (argc >= first + 2 && std::atoi(argv[first]) > 0 && std::atoi(argv[first + 1]) > 0) {
+        int width = std::atoi(argv[first]);
+        int height = std::atoi(argv[first + 1]);
+        std::mt19937 rng((uint32_t)width * 31 + height);
+        map.reset(new DenseMap(width, height));
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                map->setBlocked(x, y, (int)(rng() % 100) < obstaclePercent);
+            }
+        }
+        return first + 2;
+    }
+
+    int width, height;
+    std::vector<uint8_t> blocked;
+    if (!loadMovingAIMap(argv[first], width, height, blocked)) {
+        return 0;
+    }
+    map.reset(new DenseMap(width, height));
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            map->setBlocked(x, y, blocked[(size_t)y * width + x] != 0);
+        }
+    }
+    return first + 1;
+}
+
+// Function to time A* and Dijkstra over a large dense map, for comparing the
+// cell layouts (build once per CELL_LAYOUT_* setting and compare the output)
+int runLayoutBenchmark(int argc, char* argv[]) {
+    std::unique_ptr<DenseMap> mapStorage;
+    int nextArg = readMapArguments(argc, argv, 2, 25, mapStorage);
+    if (nextArg == 0) {
+        return 1;
+    }
+    const DenseMap& map = *mapStorage;
+    int width = map.width();
+    int height = map.height();
+    int queries = argc > nextArg ? std::atoi(argv[nextArg]) : 20;
+    uint32_t seed = argc > nextArg + 1 ? (uint32_t)std::strtoul(argv[nextArg + 1], nullptr, 10) : 1;
+    std::mt19937 rng(seed);
+
+    // Pick endpoints up front so both searches answer the same queries
+    std::vector<std::pair<Node, Node>> endpoints;
+    std::uniform_int_distribution<int> pickX(0, width - 1);
+    std::uniform_int_distribution<int> pickY(0, height - 1);
+    for (int attempts = 0; (int)endpoints.size() < queries && attempts < queries * 1000; attempts++) {
+        Node from = { pickX(rng), pickY(rng), 0, 0, 0 };
+        Node to = { pickX(rng), pickY(rng), 0, 0, 0 };
+        if (!map.isBlocked(from.x, from.y) && !map.isBlocked(to.x, to.y)) {
+            endpoints.push_back(std::make_pair(from, to));
+        }
+    }
+
+    std::cout << "Layout: " << CELL_LAYOUT_NAME << ", map " << width << "x" << height
+              << ", " << endpoints.size() << " queries" << std::endl;
+
+    DenseSearchState state(width, height);
+    CompactSearchState compactState(width, height);
+    bool compact = fitsCompactSearch(map);
+    size_t cells = (size_t)width * height;
+    std::cout << "Search state: " << sizeof(CellRecord) * CellLayout(width, height).size() / (double)cells
+              << " bytes/cell, compact " << compactState.memoryBytes() / (double)cells << " bytes/cell" << std::endl;
+
+    const char* names[] = { "A*", "Dijkstra", "compact A*", "compact Dijkstra" };
+    for (int variant = 0; variant < (compact ? 4 : 2); variant++) {
+        bool useHeuristic = variant % 2 == 0;
+        double totalMs = 0;
+        size_t expanded = 0;
+        size_t found = 0;
+        std::vector<Node> path;
+        auto countExpansion = [&expanded](const Node&) { expanded++; };
+        for (size_t q = 0; q < endpoints.size(); q++) {
+            const Node& from = endpoints[q].first;
+            const Node& to = endpoints[q].second;
+            state.reset();
+            compactState.reset();
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            bool ok = variant < 2 ? aStarSearch(map, state, from, to, path, countExpansion, useHeuristic)
+                                  : compactAStarSearch(map, compactState, from, to, path, countExpansion, useHeuristic);
+            totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            if (ok) {
+                found++;
+            }
+        }
+        std::cout << names[variant] << ": " << totalMs << " ms total, " << found << " paths, "
+                  << expanded << " expansions, " << (totalMs > 0 ? expanded / totalMs / 1000.0 : 0)
+                  << " M expansions/s" << std::endl;
+    }
+    return 0;
+}
+
+// Runs work(i) for every i in [begin, end) on up to threadCount threads
+template <typename Work>
+void parallelFor(size_t begin, size_t end, unsigned threadCount, Work work) {
+    std::atomic<size_t> next(begin);
+    auto run = [&]() {
+        for (size_t i = next++; i < end; i = next++) {
+            work(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount && t < end - begin; t++) {
+        threads.push_back(std::thread(run));
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Hash-distributed parallel A* (HDA*) -------------------------------------
+//
+// One hard query spread over several threads. Every cell has an owner
+// thread, picked by Zobrist-hashing its HDA_ZONE x HDA_ZONE zone, so
+// neighbouring cells mostly share an owner and few moves cross threads. Each
+// thread keeps its own open list and only it touches the g values and parent
+// directions of the cells it owns. A generated neighbour owned elsewhere is
+// sent to its owner through a lock-free inbox in batches.
+//
+// Threads expand in parallel, so the first goal expansion need not be
+// optimal. It only sets an incumbent cost, and nodes with f at or above it
+// are pruned. The search ends when no thread has a node below the incumbent
+// and no message is in flight. workCount tracks this: it counts busy
+// threads plus unprocessed messages. Only a busy thread can send, and only a
+// message can wake an idle thread, so once the count reaches zero it stays
+// there and the incumbent is optimal.
+const int HDA_ZONE = 8;
+const size_t HDA_BATCH = 64;       // Messages buffered per destination before a send
+const int HDA_POLL_INTERVAL = 32;  // Expansions between inbox checks
+
+struct HdaMessage {
+    uint32_t cell;      // Row-major cell id
+    uint32_t g;
+    uint32_t direction; // Move that reached the cell
+};
+
+struct HdaBatch {
+    HdaBatch* next;
+    std::vector<HdaMessage> messages;
+};
+
+// Multi-producer inbox: senders push whole batches onto a lock-free stack and
+// the owner takes the entire stack at once, so there is no ABA on pop
+class HdaInbox {
+public:
+    HdaInbox() : head(nullptr) {}
+    ~HdaInbox() { release(takeAll()); }
+
+    void push(HdaBatch* batch) {
+        batch->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(batch->next, batch, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    HdaBatch* takeAll() { return head.exchange(nullptr, std::memory_order_acquire); }
+
+    static void release(HdaBatch* batch) {
+        while (batch != nullptr) {
+            HdaBatch* next = batch->next;
+            delete batch;
+            batch = next;
+        }
+    }
+
+private:
+    std::atomic<HdaBatch*> head;
+};
+
+struct HdaEntry {
+    uint32_t f, g, cell;
+
+    // Lowest f first, ties to the deeper node as in Node
+    bool operator<(const HdaEntry& other) const {
+        return f > other.f || (f == other.f && g < other.g);
+    }
+};
+
+template <typename Map>
+class ParallelAStarSearch {
+public:
+    ParallelAStarSearch(const Map& map, unsigned threadCount)
+        : map(map), threadCount(std::max(threadCount, 1u)), width((uint32_t)map.width()),
+          gValues(map.width(), map.height(), UINT32_MAX), parents(map.width(), map.height(), 0),
+          zobristX((map.width() + HDA_ZONE - 1) / HDA_ZONE), zobristY((map.height() + HDA_ZONE - 1) / HDA_ZONE),
+          expansionCount(0), messageCount(0) {
+        std::mt19937 rng(12345);
+        for (uint32_t& key : zobristX) {
+            key = rng();
+        }
+        for (uint32_t& key : zobristY) {
+            key = rng();
+        }
+    }
+
+    // Runs one query on all threads. On success path holds the cells from
+    // start to goal, inclusive.
+    bool search(const Node& from, const Node& to, std::vector<Node>& path) {
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+
+        goal = to;
+        gValues.fill(UINT32_MAX);
+        incumbent = UINT32_MAX;
+        expansionCount = 0;
+        messageCount = 0;
+        std::vector<HdaInbox> inboxes(threadCount);
+
+        // Seed the start cell's owner with a message from nowhere
+        HdaBatch* seed = new HdaBatch;
+        HdaMessage first = { (uint32_t)from.y * width + from.x, 0, 0 };
+        seed->messages.push_back(first);
+        workCount = 1;
+        inboxes[owner(from.x, from.y)].push(seed);
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 1; t < threadCount; t++) {
+            threads.push_back(std::thread(&ParallelAStarSearch::work, this, t, std::ref(inboxes)));
+        }
+        work(0, inboxes);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        path.clear();
+        if (incumbent == UINT32_MAX) {
+            return false;
+        }
+
+        // Follow parent directions back from the goal. Every g was set from
+        // a parent's g plus one and parent g values only fall later, so the
+        // chain strictly descends to the start.
+        int x = to.x;
+        int y = to.y;
+        while (x != from.x || y != from.y) {
+            Node step = { x, y, 0, 0, 0 };
+            path.push_back(step);
+            unsigned direction = parents.at(x, y);
+            x -= dx[direction];
+            y -= dy[direction];
+        }
+        Node step = { from.x, from.y, 0, 0, 0 };
+        path.push_back(step);
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+
+    size_t expansions() const { return expansionCount; }
+    size_t messages() const { return messageCount; }
+
+private:
+    unsigned owner(int x, int y) const {
+        return (zobristX[x / HDA_ZONE] ^ zobristY[y / HDA_ZONE]) % threadCount;
+    }
+
+    uint32_t heuristic(int x, int y) const {
+        return (uint32_t)(std::abs(x - goal.x) + std::abs(y - goal.y));
+    }
+
+    // Lowers the incumbent solution cost to cost if that improves it
+    void offerSolution(uint32_t cost) {
+        uint32_t current = incumbent.load();
+        while (cost < current && !incumbent.compare_exchange_weak(current, cost)) {
+        }
+    }
+
+    // Records a better g for a cell owned by the calling thread
+    bool improve(uint32_t cell, uint32_t g, uint32_t direction, std::priority_queue<HdaEntry>& openSet) {
+        int x = (int)(cell % width);
+        int y = (int)(cell / width);
+        uint32_t f = g + heuristic(x, y);
+        if (f >= incumbent.load(std::memory_order_relaxed) || g >= gValues.at(x, y)) {
+            return false;
+        }
+        gValues.at(x, y) = g;
+        parents.at(x, y) = (uint8_t)direction;
+        HdaEntry entry = { f, g, cell };
+        openSet.push(entry);
+        return true;
+    }
+
+    void work(unsigned self, std::vector<HdaInbox>& inboxes) {
+        static const int dx[] = {-1, 1, 0, 0};
+        static const int dy[] = {0, 0, -1, 1};
+
+        std::priority_queue<HdaEntry> openSet;
+        std::vector<HdaBatch*> outgoing(threadCount, nullptr);
+        size_t expanded = 0;
+        size_t sent = 0;
+        bool busy = false;
+
+        auto send = [&](unsigned target) {
+            HdaBatch* batch = outgoing[target];
+            outgoing[target] = nullptr;
+            workCount.fetch_add((int64_t)batch->messages.size());
+            sent += batch->messages.size();
+            inboxes[target].push(batch);
+        };
+
+        while (true) {
+            HdaBatch* received = inboxes[self].takeAll();
+            if (received != nullptr) {
+                if (!busy) {
+                    workCount.fetch_add(1);
+                    busy = true;
+                }
+                int64_t count = 0;
+                for (HdaBatch* batch = received; batch != nullptr; batch = batch->next) {
+                    for (const HdaMessage& message : batch->messages) {
+                        improve(message.cell, message.g, message.direction, openSet);
+                    }
+                    count += (int64_t)batch->messages.size();
+                }
+                HdaInbox::release(received);
+                workCount.fetch_sub(count);
+            }
+
+            uint32_t bound = incumbent.load();
+            if (!openSet.empty() && openSet.top().f < bound) {
+                for (int i = 0; i < HDA_POLL_INTERVAL && !openSet.empty() && openSet.top().f < bound; i++) {
+                    HdaEntry current = openSet.top();
+                    openSet.pop();
+                    int x = (int)(current.cell % width);
+                    int y = (int)(current.cell / width);
+                    if (current.g > gValues.at(x, y)) {
+                        continue; // Reached more cheaply since it was queued
+                    }
+                    expanded++;
+
+                    if (x == goal.x && y == goal.y) {
+                        offerSolution(current.g);
+                        bound = incumbent.load();
+                        continue;
+                    }
+
+                    for (unsigned d = 0; d < 4; d++) {
+                        int newX = x + dx[d];
+                        int newY = y + dy[d];
+                        if (newX < 0 || newX >= map.width() || newY < 0 || newY >= map.height() ||
+                            map.isBlocked(newX, newY) || current.g + 1 + heuristic(newX, newY) >= bound) {
+                            continue;
+                        }
+
+                        uint32_t cell = (uint32_t)newY * width + newX;
+                        unsigned target = owner(newX, newY);
+                        if (target == self) {
+                            improve(cell, current.g + 1, d, openSet);
+                            continue;
+                        }
+                        if (outgoing[target] == nullptr) {
+                            outgoing[target] = new HdaBatch;
+                        }
+                        HdaMessage message = { cell, current.g + 1, d };
+                        outgoing[target]->messages.push_back(message);
+                        if (outgoing[target]->messages.size() >= HDA_BATCH) {
+                            send(target);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            // Nothing left below the incumbent: hand off pending messages and go idle
+            for (unsigned target = 0; target < threadCount; target++) {
+                if (outgoing[target] != nullptr) {
+                    send(target);
+                }
+            }
+            if (busy) {
+                std::priority_queue<HdaEntry>().swap(openSet); // The rest can never beat the incumbent
+                busy = false;
+                workCount.fetch_sub(1);
+            }
+            if (workCount.load() == 0) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+
+        expansionCount += expanded;
+        messageCount += sent;
+    }
+
+    const Map& map;
+    unsigned threadCount;
+    uint32_t width;
+    Node goal;
+    CellArray<uint32_t> gValues;
+    CellArray<uint8_t> parents;
+    std::vector<uint32_t> zobristX, zobristY;
+    std::atomic<uint32_t> incumbent;
+    std::atomic<int64_t> workCount;
+    std::atomic<size_t> expansionCount;
+    std::atomic<size_t> messageCount;
+};
+
+// Function to time HDA* on long queries at increasing thread counts, against
+// sequential A* on the same queries
+int runParallelBenchmark(int argc, char* argv[]) {
+    std::unique_ptr<DenseMap> mapStorage;
+    int nextArg = readMapArguments(argc, argv, 2, 25, mapStorage);
+    if (nextArg == 0) {
+        return 1;
+    }
+    const DenseMap& map = *mapStorage;
+    int width = map.width();
+    int height = map.height();
+    unsigned maxThreads = argc > nextArg ? (unsigned)std::atoi(argv[nextArg]) : std::thread::hardware_concurrency();
+    maxThreads = std::max(maxThreads, 1u);
+    int queries = argc > nextArg + 1 ? std::atoi(argv[nextArg + 1]) : 5;
+    uint32_t seed = argc > nextArg + 2 ? (uint32_t)std::strtoul(argv[nextArg + 2], nullptr, 10) : 1;
+    std::mt19937 rng(seed);
+
+    // Hard queries: endpoints at least half the map's perimeter apart
+    std::vector<std::pair<Node, Node>> endpoints;
+    std::uniform_int_distribution<int> pickX(0, width - 1);
+    std::uniform_int_distribution<int> pickY(0, height - 1);
+    for (int attempts = 0; (int)endpoints.size() < queries && attempts < queries * 100000; attempts++) {
+        Node from = { pickX(rng), pickY(rng), 0, 0, 0 };
+        Node to = { pickX(rng), pickY(rng), 0, 0, 0 };
+        if (!map.isBlocked(from.x, from.y) && !map.isBlocked(to.x, to.y) &&
+            calculateManhattanDistance(from, to) >= (width + height) / 2) {
+            endpoints.push_back(std::make_pair(from, to));
+        }
+    }
+
+    std::cout << "Map " << width << "x" << height << ", " << endpoints.size() << " queries, zone "
+              << HDA_ZONE << ", " << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+
+    // Sequential A* gives the reference costs and time
+    std::vector<int> costs;
+    double sequentialMs = 0;
+    {
+        DenseSearchState state(width, height);
+        std::vector<Node> path;
+        for (const std::pair<Node, Node>& query : endpoints) {
+            state.reset();
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            bool found = aStarSearch(map, state, query.first, query.second, path, [](const Node&) {});
+            sequentialMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            costs.push_back(found ? (int)path.size() - 1 : -1);
+        }
+    }
+    std::cout << "sequential A*: " << sequentialMs << " ms" << std::endl;
+
+    double oneThreadMs = 0;
+    for (unsigned threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        ParallelAStarSearch<DenseMap> search(map, threads);
+        std::vector<Node> path;
+        double totalMs = 0;
+        size_t expanded = 0;
+        size_t messages = 0;
+        int mismatches = 0;
+        for (size_t q = 0; q < endpoints.size(); q++) {
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            bool found = search.search(endpoints[q].first, endpoints[q].second, path);
+            totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            expanded += search.expansions();
+            messages += search.messages();
+            if ((found ? (int)path.size() - 1 : -1) != costs[q]) {
+                mismatches++;
+            }
+        }
+        if (threads == 1) {
+            oneThreadMs = totalMs;
+        }
+
+        std::cout << "HDA* " << threads << " threads: " << totalMs << " ms, speedup "
+                  << (totalMs > 0 ? oneThreadMs / totalMs : 0) << "x over 1 thread, "
+                  << (totalMs > 0 ? sequentialMs / totalMs : 0) << "x over sequential, " << expanded
+                  << " expansions, " << messages << " messages, "
+                  << mismatches << " non-optimal" << std::endl;
+        if (mismatches > 0) {
+            return 2;
+        }
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    return 0;
+}
+
+// Cooperative multi-agent pathfinding ------------------------------------
+//
+// Agents are planned one after another in priority order through a shared
+// space-time reservation table, each avoiding the cell-times and moves of the
+// agents planned before it (Cooperative A*). With a window, each agent only
+// plans and reserves `window` steps ahead, guided by the true distance to its
+// goal, and everyone replans after half a window (windowed HCA*). An agent
+// that keeps finding no plan is pinned: the round is redone with it holding its
+// cell before anyone else plans, so a hold never clashes with a committed plan.
+
+// Neighbour moves, with "wait" as direction 4. Opposite moves are d ^ 1.
+const int AGENT_DX[] = {-1, 1, 0, 0, 0};
+const int AGENT_DY[] = {0, 0, -1, 1, 0};
+const int AGENT_WAIT = 4;
+const uint16_t UNREACHABLE = 0xFFFF;
+
+class ReservationTable {
+public:
+    explicit ReservationTable(int width) : width((uint32_t)width) {}
+
+    // Whether (x, y) is free at time t for the agent that starts at `own`;
+    // an agent is never kept out by its own held cell
+    bool cellFree(int x, int y, int t, const Node& own) const {
+        uint32_t cell = cellId(x, y);
+        if (cells.count(key(cell, t))) {
+            return false;
+        }
+        if (x != own.x || y != own.y) {
+            std::unordered_map<uint32_t, int>::const_iterator held = heldUntil.find(cell);
+            if (held != heldUntil.end() && t <= held->second) {
+                return false;
+            }
+        }
+        std::unordered_map<uint32_t, int>::const_iterator rest = restingFrom.find(cell);
+        return rest == restingFrom.end() || t < rest->second;
+    }
+
+    // Whether moving in direction d from (x, y) between t and t + 1 avoids a
+    // head-on swap with an agent making the opposite move
+    bool moveFree(int x, int y, int d, int t) const {
+        if (d == AGENT_WAIT) {
+            return true;
+        }
+        return !moves.count(key(cellId(x + AGENT_DX[d], y + AGENT_DY[d]) | ((uint32_t)(d ^ 1) << 30), t));
+    }
+
+    // Last time step anything is reserved at the cell for the agent that
+    // starts at `own`, or -1
+    int lastReserved(int x, int y, const Node& own) const {
+        uint32_t cell = cellId(x, y);
+        std::unordered_map<uint32_t, int>::const_iterator latest = lastUse.find(cell);
+        int last = latest == lastUse.end() ? -1 : latest->second;
+        if (x != own.x || y != own.y) {
+            std::unordered_map<uint32_t, int>::const_iterator held = heldUntil.find(cell);
+            if (held != heldUntil.end()) {
+                last = std::max(last, held->second);
+            }
+        }
+        return last;
+    }
+
+    // Whether a plan (positions[t] and the move taken at each step) is still
+    // compatible with everything reserved so far
+    bool pathFree(const std::vector<Node>& positions, const std::vector<int>& directions, bool rests) const {
+        const Node& own = positions.front();
+        for (size_t t = 0; t < positions.size(); t++) {
+            if (!cellFree(positions[t].x, positions[t].y, (int)t, own)) {
+                return false;
+            }
+            if (t + 1 < positions.size() && !moveFree(positions[t].x, positions[t].y, directions[t], (int)t)) {
+                return false;
+            }
+        }
+        const Node& last = positions.back();
+        return !rests || lastReserved(last.x, last.y, own) < (int)positions.size();
+    }
+
+    // Keeps the cell an agent stands on out of everyone else's plans up to
+    // time `until`, until the agent's own plan is reserved
+    void holdCell(const Node& cell, int until) {
+        heldUntil[cellId(cell.x, cell.y)] = until;
+    }
+
+    void releaseCell(const Node& cell) {
+        heldUntil.erase(cellId(cell.x, cell.y));
+    }
+
+    // Reserves a plan; with rests set the agent also stays at its final cell forever
+    void reservePath(const std::vector<Node>& positions, const std::vector<int>& directions, bool rests) {
+        for (size_t t = 0; t < positions.size(); t++) {
+            uint32_t cell = cellId(positions[t].x, positions[t].y);
+            cells.insert(key(cell, (int)t));
+            int& latest = lastUse.insert(std::make_pair(cell, -1)).first->second;
+            latest = std::max(latest, (int)t);
+            if (t + 1 < positions.size() && directions[t] != AGENT_WAIT) {
+                moves.insert(key(cell | ((uint32_t)directions[t] << 30), (int)t));
+            }
+        }
+        if (rests) {
+            const Node& last = positions.back();
+            restingFrom[cellId(last.x, last.y)] = (int)positions.size();
+        }
+    }
+
+    void clear() {
+        cells.clear();
+        moves.clear();
+        lastUse.clear();
+        restingFrom.clear();
+        heldUntil.clear();
+    }
+
+private:
+    uint32_t cellId(int x, int y) const { return (uint32_t)y * width + x; }
+    static uint64_t key(uint32_t cell, int t) { return (uint64_t)t << 32 | cell; }
+
+    uint32_t width;
+    std::unordered_set<uint64_t> cells;
+    std::unordered_set<uint64_t> moves;
+    std::unordered_map<uint32_t, int> lastUse;
+    std::unordered_map<uint32_t, int> restingFrom;
+    std::unordered_map<uint32_t, int> heldUntil;
+};
+
+struct Agent {
+    Node position;
+    Node goal;
+    CellArray<uint16_t> goalDistance; // True distance to the goal, the HCA* heuristic
+    std::vector<Node> plan;           // plan[t] is the agent's cell t steps from now
+    std::vector<int> directions;      // Move taken from plan[t] to plan[t + 1]
+    bool planned;
+    bool pinned;                      // Holds its cell this round, reserved before anyone plans
+};
+
+// Function to fill a table with the BFS distance from goal to every cell
+void computeGoalDistances(const DenseMap& map, const Node& goal, CellArray<uint16_t>& distance) {
+    distance.fill(UNREACHABLE);
+    std::queue<Node> q;
+    distance.at(goal.x, goal.y) = 0;
+    q.push(goal);
+    while (!q.empty()) {
+        Node current = q.front();
+        q.pop();
+        uint16_t next = (uint16_t)std::min<int>(distance.at(current.x, current.y) + 1, UNREACHABLE - 1);
+        for (int d = 0; d < 4; d++) {
+            int newX = current.x + AGENT_DX[d];
+            int newY = current.y + AGENT_DY[d];
+            if (newX >= 0 && newX < map.width() && newY >= 0 && newY < map.height() &&
+                !map.isBlocked(newX, newY) && distance.at(newX, newY) == UNREACHABLE) {
+                distance.at(newX, newY) = next;
+                Node neighbor = { newX, newY, 0, 0, 0 };
+                q.push(neighbor);
+            }
+        }
+    }
+}
+
+// Space-time A* for one agent against the reservation table. With a window
+// the search ends at time `window`; otherwise it ends once the agent stands on
+// its goal with nothing reserved there afterwards, giving up past `horizon`.
+bool planAgent(const DenseMap& map, const ReservationTable& table, Agent& agent, int window, int horizon) {
+    struct TimedNode {
+        int x, y, t;
+        int g, f;
+        bool operator<(const TimedNode& other) const {
+            return f > other.f || (f == other.f && g < other.g);
+        }
+    };
+
+    const uint32_t width = (uint32_t)map.width();
+    auto key = [width](int x, int y, int t) { return (uint64_t)t << 32 | ((uint32_t)y * width + x); };
+
+    std::priority_queue<TimedNode> openSet;
+    std::unordered_map<uint64_t, int> cameFrom; // Direction of the move into each expanded state
+    std::unordered_set<uint64_t> closedSet;
+
+    const Node& from = agent.position;
+    const Node& goal = agent.goal;
+    TimedNode first = { from.x, from.y, 0, 0, agent.goalDistance.at(from.x, from.y) };
+    openSet.push(first);
+    cameFrom[key(from.x, from.y, 0)] = AGENT_WAIT;
+
+    while (!openSet.empty()) {
+        TimedNode current = openSet.top();
+        openSet.pop();
+        uint64_t currentKey = key(current.x, current.y, current.t);
+        if (!closedSet.insert(currentKey).second) {
+            continue;
+        }
+
+        bool atGoal = current.x == goal.x && current.y == goal.y;
+        bool done = window > 0 ? current.t == window
+                               : atGoal && table.lastReserved(goal.x, goal.y, from) < current.t;
+        if (done) {
+            // Walk the recorded moves back to time 0
+            agent.plan.assign(current.t + 1, from);
+            agent.directions.assign(current.t + 1, AGENT_WAIT);
+            int x = current.x;
+            int y = current.y;
+            for (int t = current.t; t > 0; t--) {
+                Node step = { x, y, 0, 0, 0 };
+                agent.plan[t] = step;
+                int d = cameFrom[key(x, y, t)];
+                agent.directions[t - 1] = d;
+                x -= AGENT_DX[d];
+                y -= AGENT_DY[d];
+            }
+            return true;
+        }
+        if (current.t >= horizon) {
+            continue;
+        }
 
-// Grid representation
-std::vector<std::vector<int>> grid(ROWS, std::vector<int>(COLUMNS, 0));
+        for (int d = 0; d <= AGENT_WAIT; d++) {
+            int newX = current.x + AGENT_DX[d];
+            int newY = current.y + AGENT_DY[d];
+            int t = current.t + 1;
+            if (newX < 0 || newX >= map.width() || newY < 0 || newY >= map.height() || map.isBlocked(newX, newY) ||
+                !table.cellFree(newX, newY, t, from) || !table.moveFree(current.x, current.y, d, current.t)) {
+                continue;
+            }
 
-// Start and end points
-Node start, end;
+            uint64_t newKey = key(newX, newY, t);
+            if (closedSet.count(newKey)) {
+                continue;
+            }
 
-// State variable to track input order
-enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_DONE };
-InputState currentState = INPUT_START;
+            // Waiting on the goal is free, so finished agents cost nothing to keep
+            int g = current.g + ((d == AGENT_WAIT && atGoal) ? 0 : 1);
+            TimedNode next = { newX, newY, t, g, g + agent.goalDistance.at(newX, newY) };
+            std::unordered_map<uint64_t, int>::iterator seen = cameFrom.find(newKey);
+            if (seen == cameFrom.end()) {
+                cameFrom[newKey] = d;
+                openSet.push(next);
+            }
+            else if (g < current.g + 1) {
+                // Only the free goal wait can beat an earlier arrival at the same state
+                seen->second = d;
+                openSet.push(next);
+            }
+        }
+    }
+    return false;
+}
 
-// Function to initialize SDL
-bool init() {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        std::cerr << "SDL could not initialize! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
+// Function to make an agent's plan staying where it is: for the whole window
+// (it stays put while half of it is executed), or resting for good without one
+void holdPosition(Agent& agent, int window) {
+    size_t holdSteps = window > 0 ? (size_t)window + 1 : 1;
+    agent.plan.assign(holdSteps, agent.position);
+    agent.directions.assign(holdSteps, AGENT_WAIT);
+}
+
+// Function to plan one round for all agents, in the given priority order.
+// Agents are planned speculatively in parallel batches against the table as it
+// stood when the batch started, then committed in order; a plan that clashes
+// with a reservation committed in the meantime is redone against the live table.
+// Agents that found no plan go in failedAgents; the caller redoes the round.
+void planRound(const DenseMap& map, ReservationTable& table, std::vector<Agent>& agents,
+               const std::vector<size_t>& order, int window, unsigned threadCount,
+               size_t& replanned, std::vector<size_t>& failedAgents) {
+    bool rests = window == 0;
+    size_t batchSize = threadCount > 1 ? threadCount * 4 : 1;
+
+    // Pinned agents hold first, so nothing can be planned through them. Every
+    // other agent keeps its cell for the first step, until it is planned itself.
+    std::vector<size_t> unpinned;
+    for (size_t a : order) {
+        Agent& agent = agents[a];
+        if (agent.pinned) {
+            holdPosition(agent, window);
+            agent.planned = true;
+            table.reservePath(agent.plan, agent.directions, rests);
+        }
+        else {
+            table.holdCell(agent.position, 1);
+            unpinned.push_back(a);
+        }
     }
 
-    gWindow = SDL_CreateWindow("Pathfinding Visualization", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, SCREEN_WIDTH, SCREEN_HEIGHT, SDL_WINDOW_SHOWN);
-    if (gWindow == nullptr) {
-        std::cerr << "Window could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
+    for (size_t batchStart = 0; batchStart < unpinned.size(); batchStart += batchSize) {
+        size_t batchEnd = std::min(unpinned.size(), batchStart + batchSize);
+
+        parallelFor(batchStart, batchEnd, threadCount, [&](size_t i) {
+            Agent& agent = agents[unpinned[i]];
+            int horizon = window > 0 ? window : agent.goalDistance.at(agent.position.x, agent.position.y) * 2 + 64;
+            agent.planned = planAgent(map, table, agent, window, horizon);
+        });
+
+        for (size_t i = batchStart; i < batchEnd; i++) {
+            Agent& agent = agents[unpinned[i]];
+            if (agent.planned && !table.pathFree(agent.plan, agent.directions, rests)) {
+                int horizon = window > 0 ? window : agent.goalDistance.at(agent.position.x, agent.position.y) * 2 + 64;
+                agent.planned = planAgent(map, table, agent, window, horizon);
+                replanned++;
+            }
+            table.releaseCell(agent.position);
+            if (!agent.planned) {
+                // Keep the others routing around it for the rest of this attempt,
+                // but only where holding does not clash with what is committed
+                failedAgents.push_back(unpinned[i]);
+                holdPosition(agent, window);
+                if (!table.pathFree(agent.plan, agent.directions, rests)) {
+                    continue;
+                }
+            }
+            table.reservePath(agent.plan, agent.directions, rests);
+        }
     }
+}
 
-    gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED);
-    if (gRenderer == nullptr) {
-        std::cerr << "Renderer could not be created! SDL_Error: " << SDL_GetError() << std::endl;
-        return false;
+// Function to run the multi-agent mode: random agents on a dense map, planned
+// cooperatively, then the executed schedule is checked for collisions
+int runMultiAgent(int argc, char* argv[]) {
+    std::unique_ptr<DenseMap> mapStorage;
+    int nextArg = readMapArguments(argc, argv, 2, 10, mapStorage);
+    if (nextArg == 0) {
+        return 1;
+    }
+    const DenseMap& map = *mapStorage;
+    int agentCount = argc > nextArg ? std::atoi(argv[nextArg]) : 500;
+    int window = argc > nextArg + 1 ? std::atoi(argv[nextArg + 1]) : 16;
+    unsigned threadCount = argc > nextArg + 2 ? (unsigned)std::atoi(argv[nextArg + 2]) : std::thread::hardware_concurrency();
+    uint32_t seed = argc > nextArg + 3 ? (uint32_t)std::strtoul(argv[nextArg + 3], nullptr, 10) : 1;
+    threadCount = std::max(threadCount, 1u);
+    if (window == 1) {
+        window = 2; // Replanning every half window needs at least two steps
     }
 
-    return true;
-}
+    // Place agents on distinct free cells, each with a reachable, distinct goal
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pickX(0, map.width() - 1);
+    std::uniform_int_distribution<int> pickY(0, map.height() - 1);
+    std::unordered_set<uint64_t> usedStarts, usedGoals;
+    std::vector<Agent> agents;
+    std::chrono::steady_clock::time_point setupBegin = std::chrono::steady_clock::now();
+    for (int attempts = 0; (int)agents.size() < agentCount && attempts < agentCount * 100; attempts++) {
+        Node goal = { pickX(rng), pickY(rng), 0, 0, 0 };
+        uint64_t goalKey = (uint64_t)goal.y * map.width() + goal.x;
+        if (map.isBlocked(goal.x, goal.y) || usedGoals.count(goalKey)) {
+            continue;
+        }
 
-// Function to handle mouse clicks
-void handleMouseClick(SDL_Event& event) {
-    int mouseX, mouseY;
-    SDL_GetMouseState(&mouseX, &mouseY);
+        Agent agent = { goal, goal, CellArray<uint16_t>(map.width(), map.height(), UNREACHABLE),
+                        std::vector<Node>(), std::vector<int>(), false, false };
+        computeGoalDistances(map, goal, agent.goalDistance);
+        for (int tries = 0; tries < 100; tries++) {
+            Node from = { pickX(rng), pickY(rng), 0, 0, 0 };
+            uint64_t startKey = (uint64_t)from.y * map.width() + from.x;
+            if (agent.goalDistance.at(from.x, from.y) != UNREACHABLE && !usedStarts.count(startKey)) {
+                agent.position = from;
+                usedStarts.insert(startKey);
+                usedGoals.insert(goalKey);
+                agents.push_back(std::move(agent));
+                break;
+            }
+        }
+    }
+    double setupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - setupBegin).count();
 
-    int gridX = mouseX / GRID_SIZE;
-    int gridY = mouseY / GRID_SIZE;
+    std::cout << "Agents: " << agents.size() << ", map " << map.width() << "x" << map.height()
+              << ", window " << (window > 0 ? std::to_string(window) : std::string("full")) << ", threads " << threadCount
+              << std::endl;
+    std::cout << "Goal distance tables: " << setupMs << " ms" << std::endl;
 
-    if (gridX >= 0 && gridX < COLUMNS && gridY >= 0 && gridY < ROWS) {
-        if (currentState == INPUT_START) {
-            start = { gridX, gridY, 0, 0, 0 };
-            grid[gridY][gridX] = 2;
-            currentState = INPUT_END;
+    // history[a][t] is where agent a stood at time t of the executed schedule
+    std::vector<std::vector<Node>> history(agents.size());
+    for (size_t a = 0; a < agents.size(); a++) {
+        history[a].push_back(agents[a].position);
+    }
+
+    ReservationTable table(map.width());
+    std::vector<size_t> order(agents.size());
+    size_t plans = 0, replanned = 0;
+    size_t failed = 0; // Failed plans over the whole run, in any attempt
+    size_t pinned = 0; // Agent-rounds spent holding after a failed plan
+    std::vector<size_t> failedAgents;
+    double planningMs = 0;
+    int maxRounds = window > 0 ? 8 * (map.width() + map.height()) / std::max(window / 2, 1) : 1;
+
+    for (int round = 0; round < maxRounds; round++) {
+        bool allHome = true;
+        for (const Agent& agent : agents) {
+            allHome = allHome && agent.position.x == agent.goal.x && agent.position.y == agent.goal.y;
         }
-        else if (currentState == INPUT_END) {
-            end = { gridX, gridY, 0, 0, 0 };
-            grid[gridY][gridX] = 3;
-            currentState = INPUT_HURDLES;
+        if (allHome && round > 0) {
+            break;
+        }
+
+        // Rotate priorities each round so no agent is always planned last
+        for (size_t i = 0; i < order.size(); i++) {
+            order[i] = (i + (size_t)round) % order.size();
+        }
+
+        // If some agents found no path the round is redone with those agents
+        // first in the order. After a few tries they are pinned instead; every
+        // later retry pins at least one more agent, so this ends.
+        const int reorderAttempts = 3;
+        for (Agent& agent : agents) {
+            agent.pinned = false;
+        }
+        size_t pinnedThisRound = 0;
+        for (int attempt = 0;; attempt++) {
+            table.clear();
+            failedAgents.clear();
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            planRound(map, table, agents, order, window, threadCount, replanned, failedAgents);
+            planningMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            failed += failedAgents.size();
+            if (failedAgents.empty()) {
+                break;
+            }
+            if (attempt < reorderAttempts) {
+                std::stable_partition(order.begin(), order.end(), [&agents](size_t a) { return !agents[a].planned; });
+                continue;
+            }
+            for (size_t a : failedAgents) {
+                agents[a].pinned = true;
+            }
+            pinnedThisRound += failedAgents.size();
         }
-        else if (currentState == INPUT_HURDLES) {
-            // Left click sets hurdles
-            if (event.button.button == SDL_BUTTON_LEFT) {
-                grid[gridY][gridX] = 1;
+        // Only the plans of the attempt that is kept count as planned
+        plans += agents.size() - pinnedThisRound;
+        pinned += pinnedThisRound;
+
+        // Execute half a window (or the whole plan without one)
+        for (size_t a = 0; a < agents.size(); a++) {
+            Agent& agent = agents[a];
+            size_t steps = window > 0 ? (size_t)window / 2 : agent.plan.size() - 1;
+            for (size_t t = 1; t <= steps; t++) {
+                agent.position = agent.plan[std::min(t, agent.plan.size() - 1)];
+                history[a].push_back(agent.position);
             }
         }
     }
-}
 
-// Function to render the grid
-void renderGrid() {
-    SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255);
-    for (int i = 0; i < ROWS; i++) {
-        for (int j = 0; j < COLUMNS; j++) {
-            if (grid[i][j] == 1) {
-                SDL_SetRenderDrawColor(gRenderer, 139, 69, 19, 255); // Brown for hurdles
+    // Check the executed schedule: no shared cell-times and no swaps
+    size_t steps = 0;
+    for (const std::vector<Node>& positions : history) {
+        steps = std::max(steps, positions.size());
+    }
+    size_t conflicts = 0;
+    size_t makespan = 0;
+    size_t arrived = 0;
+    size_t sumOfCosts = 0;
+    std::unordered_map<uint64_t, size_t> occupant;
+    for (size_t t = 0; t < steps; t++) {
+        occupant.clear();
+        for (size_t a = 0; a < history.size(); a++) {
+            const Node& here = history[a][std::min(t, history[a].size() - 1)];
+            uint64_t cell = (uint64_t)here.y * map.width() + here.x;
+            if (!occupant.insert(std::make_pair(cell, a)).second) {
+                conflicts++;
             }
-            else if (grid[i][j] == 2) {
-                SDL_SetRenderDrawColor(gRenderer, 0, 255, 0, 255); // Start (green)
+            if (t > 0 && t < history[a].size()) {
+                const Node& before = history[a][t - 1];
+                uint64_t previous = (uint64_t)before.y * map.width() + before.x;
+                std::unordered_map<uint64_t, size_t>::iterator other = occupant.find(previous);
+                if (other != occupant.end() && other->second != a && t < history[other->second].size()) {
+                    const Node& otherBefore = history[other->second][t - 1];
+                    if ((uint64_t)otherBefore.y * map.width() + otherBefore.x == cell) {
+                        conflicts++;
+                    }
+                }
             }
-            else if (grid[i][j] == 3) {
-                SDL_SetRenderDrawColor(gRenderer, 255, 0, 0, 255); // End (red)
+        }
+    }
+    for (size_t a = 0; a < agents.size(); a++) {
+        if (agents[a].position.x == agents[a].goal.x && agents[a].position.y == agents[a].goal.y) {
+            arrived++;
+            // Cost is the time of the last arrival at the goal
+            size_t t = history[a].size();
+            while (t > 1 && history[a][t - 2].x == agents[a].goal.x && history[a][t - 2].y == agents[a].goal.y) {
+                t--;
             }
-            else if (grid[i][j] == 4) {
-                SDL_SetRenderDrawColor(gRenderer, 255, 255, 0, 255); // Path (yellow)
+            sumOfCosts += t - 1;
+            makespan = std::max(makespan, t - 1);
+        }
+    }
+
+    std::cout << "Planning: " << planningMs << " ms for " << plans << " committed agent plans (" << replanned
+              << " redone after conflicts, " << failed << " failed), "
+              << (planningMs > 0 ? plans / planningMs * 1000.0 : 0) << " agents planned/s" << std::endl;
+    std::cout << "Agents held in place after a failed plan: " << pinned << " agent-rounds" << std::endl;
+    std::cout << "Reached goal: " << arrived << "/" << agents.size() << ", sum of costs " << sumOfCosts
+              << ", makespan " << makespan << ", conflicts " << conflicts << std::endl;
+    return conflicts == 0 ? 0 : 2;
+}
+
+// Path query service ------------------------------------------------------
+//
+// A long-running mode that loads a map once and answers queries over
+// stdin/stdout or a Unix domain socket, one request per line:
+//   path <startX> <startY> <endX> <endY>  ->  ok <length> version <n> <x>,<y> ...  |  none version <n>  |  error <reason>
+//   block <x> <y> [<x> <y> ...]           ->  ok version <n> copied <chunks>
+//   unblock <x> <y> [<x> <y> ...]         ->  ok version <n> copied <chunks>
+//   stats                                 ->  stats <key>=<value> ...
+//   reload <in.map | width height>        ->  ok reloaded <width>x<height> version <n>
+//   quit                                  ->  closes the connection
+//   shutdown                              ->  stops the service
+// Replies come back in request order on each connection. Path queries from
+// all connections share one queue; a worker takes whatever has piled up (up to
+// SERVICE_MAX_BATCH) and answers the batch, reusing its search state across
+// it. Each query pins the map version current when it was read, so it sees the
+// edits sent before it on its connection and none sent after. Edits publish new
+// versions of a VersionedGrid and never wait for running searches; each path
+// reply names the version it was found on.
+const size_t SERVICE_MAX_BATCH = 64;
+const int LATENCY_BUCKETS = 32; // Bucket i counts latencies in [2^i, 2^(i+1)) microseconds
+
+struct PathRequest {
+    Node from, to;
+    std::shared_ptr<const GridSnapshot> map; // Version current when the request was read
+    std::chrono::steady_clock::time_point received;
+    std::promise<std::string> reply;
+};
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() : total(0), maxMicros(0) {
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            buckets[i] = 0;
+        }
+    }
+
+    void record(uint64_t micros) {
+        int bucket = 0;
+        while (bucket < LATENCY_BUCKETS - 1 && (micros >> (bucket + 1)) != 0) {
+            bucket++;
+        }
+        // Raise the maximum first, so a concurrent quantile never clamps below this sample
+        uint64_t seen = maxMicros.load();
+        while (micros > seen && !maxMicros.compare_exchange_weak(seen, micros)) {
+        }
+        buckets[bucket]++;
+        total++;
+    }
+
+    // Upper bound of the bucket that holds quantile q, but never above the
+    // largest latency actually seen
+    uint64_t quantile(double q) const {
+        uint64_t target = (uint64_t)std::ceil(q * total.load());
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            seen += buckets[i].load();
+            if (seen >= target && seen > 0) {
+                return std::min((uint64_t)1 << (i + 1), maxMicros.load());
             }
-            else if (grid[i][j] == 5) {
-                SDL_SetRenderDrawColor(gRenderer, 0, 255, 0, 255); // Path (green)
+        }
+        return 0;
+    }
+
+    std::string describe() const {
+        std::ostringstream out;
+        out << "requests=" << total.load() << " p50_us=" << quantile(0.5) << " p90_us=" << quantile(0.9)
+            << " p99_us=" << quantile(0.99) << " max_us=" << maxMicros.load() << " hist=";
+        bool first = true;
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            if (buckets[i].load() != 0) {
+                out << (first ? "" : ",") << ((uint64_t)1 << (i + 1)) << ":" << buckets[i].load();
+                first = false;
             }
+        }
+        return out.str();
+    }
 
-            SDL_Rect cellRect = { j * GRID_SIZE, i * GRID_SIZE, GRID_SIZE, GRID_SIZE };
-            SDL_RenderFillRect(gRenderer, &cellRect);
+private:
+    std::atomic<uint64_t> buckets[LATENCY_BUCKETS];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> maxMicros;
+};
 
-            // Reset color to white
-            SDL_SetRenderDrawColor(gRenderer, 255, 255, 255, 255);
+class PathService {
+public:
+    PathService(std::unique_ptr<DenseMap> map, unsigned workerCount)
+        : grid(map->width(), map->height()), closed(false), batchCount(0) {
+        grid.replace(*map);
+        for (unsigned i = 0; i < std::max(workerCount, 1u); i++) {
+            workers.push_back(std::thread(&PathService::workerLoop, this));
         }
     }
-}
 
-// Function to calculate the Manhattan distance heuristic
-double calculateManhattanDistance(const Node& a, const Node& b) {
-    return std::abs(a.x - b.x) + std::abs(a.y - b.y);
-}
+    ~PathService() {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            closed = true;
+        }
+        ready.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
 
-// Function to perform A* algorithm with delay
-bool aStarWithDelay(int delayMs) {
-    std::vector<std::vector<bool>> closedSet(ROWS, std::vector<bool>(COLUMNS, false));
-    std::vector<std::vector<Node>> cameFrom(ROWS, std::vector<Node>(COLUMNS)); // Keep track of where each node came from
-    std::priority_queue<Node> openSet;
+    std::future<std::string> submit(const Node& from, const Node& to) {
+        std::unique_ptr<PathRequest> request(new PathRequest());
+        request->from = from;
+        request->to = to;
+        request->map = grid.snapshot();
+        request->received = std::chrono::steady_clock::now();
+        std::future<std::string> reply = request->reply.get_future();
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            pending.push_back(std::move(request));
+        }
+        ready.notify_one();
+        return reply;
+    }
 
-    // Add the start node to the open set
-    openSet.push(start);
+    // Loads a new map and publishes it. Queries already submitted finish on the
+    // version they pinned; nothing waiting in the queue is dropped.
+    std::string reload(int argc, char* argv[]) {
+        std::unique_ptr<DenseMap> map;
+        if (readMapArguments(argc, argv, 0, 10, map) == 0) {
+            return "error could not load map";
+        }
+        if (!fitsCompactSearch(*map)) {
+            return "error map too large";
+        }
+        std::ostringstream reply;
+        reply << "ok reloaded " << map->width() << "x" << map->height() << " version " << grid.replace(*map);
+        return reply.str();
+    }
 
-    while (!openSet.empty()) {
-        Node current = openSet.top();
-        openSet.pop();
+    // Publishes obstacle edits as one new version
+    std::string edit(const std::vector<CellEdit>& edits) {
+        size_t copiedChunks = 0;
+        uint64_t version = grid.publish(edits, copiedChunks);
+        std::ostringstream reply;
+        reply << "ok version " << version << " copied " << copiedChunks;
+        return reply.str();
+    }
 
-        int x = current.x;
-        int y = current.y;
+    std::string stats() const {
+        std::shared_ptr<const GridSnapshot> map = grid.snapshot();
+        uint64_t batches = batchCount.load();
+        std::ostringstream out;
+        out << "stats map=" << map->width() << "x" << map->height() << " version=" << map->version()
+            << " batches=" << batches << " " << latency.describe();
+        return out.str();
+    }
 
-        if (x == end.x && y == end.y) {
-            // Reached the end, reconstruct the path
-            while (!(x == start.x && y == start.y)) {
-                grid[y][x] = 4; // Mark the path as yellow
+private:
+    void workerLoop() {
+        int sizedWidth = 0, sizedHeight = 0;
+        std::unique_ptr<CompactSearchState> state;
+        std::vector<Node> path;
+        std::vector<std::unique_ptr<PathRequest>> batch;
 
-                Node previous = cameFrom[y][x];
-                x = previous.x;
-                y = previous.y;
+        while (true) {
+            batch.clear();
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                ready.wait(lock, [this] { return closed || !pending.empty(); });
+                if (pending.empty()) {
+                    return; // Closed and drained
+                }
+                while (!pending.empty() && batch.size() < SERVICE_MAX_BATCH) {
+                    batch.push_back(std::move(pending.front()));
+                    pending.pop_front();
+                }
+                if (!pending.empty()) {
+                    ready.notify_one();
+                }
             }
-            grid[start.y][start.x] = 2; // Start in green
-            grid[end.y][end.x] = 3;     // End in red
+            batchCount++;
 
-            // Highlight the shortest path from start to end in green
-            x = end.x;
-            y = end.y;
-            while (!(x == start.x && y == start.y)) {
-                grid[y][x] = 5; // Mark the path as green
-                Node previous = cameFrom[y][x];
-                x = previous.x;
-                y = previous.y;
+            for (std::unique_ptr<PathRequest>& request : batch) {
+                // Requests submitted around a reload may need a different state size
+                const GridSnapshot& map = *request->map;
+                if (map.width() != sizedWidth || map.height() != sizedHeight) {
+                    state.reset(new CompactSearchState(map.width(), map.height()));
+                    sizedWidth = map.width();
+                    sizedHeight = map.height();
+                }
+                std::string reply = answer(map, *state, request->from, request->to, path);
+                request->map.reset();
+                latency.record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - request->received).count());
+                request->reply.set_value(reply);
             }
+        }
+    }
 
-            return true;
+    static std::string answer(const GridSnapshot& map, CompactSearchState& state, const Node& from, const Node& to,
+                              std::vector<Node>& path) {
+        if (from.x < 0 || from.x >= map.width() || from.y < 0 || from.y >= map.height() ||
+            to.x < 0 || to.x >= map.width() || to.y < 0 || to.y >= map.height()) {
+            return "error outside the map";
+        }
+        if (map.isBlocked(from.x, from.y) || map.isBlocked(to.x, to.y)) {
+            return "error blocked endpoint";
+        }
+
+        state.reset();
+        std::ostringstream reply;
+        if (!compactAStarSearch(map, state, from, to, path, [](const Node&) {})) {
+            reply << "none version " << map.version();
+            return reply.str();
         }
+        reply << "ok " << path.size() - 1 << " version " << map.version();
+        for (const Node& step : path) {
+            reply << " " << step.x << "," << step.y;
+        }
+        return reply.str();
+    }
 
-        closedSet[y][x] = true;
+    VersionedGrid grid;
 
-        // Generate neighbors
-        int dx[] = {-1, 1, 0, 0};
-        int dy[] = {0, 0, -1, 1};
+    std::mutex queueMutex;
+    std::condition_variable ready;
+    std::deque<std::unique_ptr<PathRequest>> pending;
+    bool closed;
+    std::vector<std::thread> workers;
 
-        for (int i = 0; i < 4; i++) {
-            int newX = x + dx[i];
-            int newY = y + dy[i];
+    std::atomic<uint64_t> batchCount;
+    LatencyHistogram latency;
+};
 
-            // Check if the neighbor is within bounds
-            if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1 && !closedSet[newY][newX]) {
-                // Calculate new g value (cost from start)
-                double tentativeG = current.g + 1.0;
+// Function to write a whole buffer to a file descriptor
+bool writeAll(int fd, const std::string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += (size_t)n;
+    }
+    return true;
+}
 
-                bool isBetterPath = false;
+// Function to read the next newline-terminated line from a file descriptor
+bool readLine(int fd, std::string& buffer, std::string& line) {
+    while (true) {
+        size_t newline = buffer.find('\n');
+        if (newline != std::string::npos) {
+            line = buffer.substr(0, newline);
+            buffer.erase(0, newline + 1);
+            if (!line.empty() && line[line.size() - 1] == '\r') {
+                line.erase(line.size() - 1);
+            }
+            return true;
+        }
 
-                // Check if this is the first visit to the neighbor
-                if (grid[newY][newX] != 4) {
-                    grid[newY][newX] = 4; // Mark it as part of the path
-                    isBetterPath = true;
-                }
-                else if (tentativeG < current.g) {
-                    isBetterPath = true;
+        char chunk[4096];
+        ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            // Answer a final line that had no newline
+            line.swap(buffer);
+            buffer.clear();
+            return !line.empty();
+        }
+        buffer.append(chunk, (size_t)n);
+    }
+}
+
+// Function to serve one connection. Lines are read here; replies are written
+// in request order by a writer thread that waits on each reply in turn.
+// Returns true if the client asked the whole service to shut down.
+bool serveConnection(PathService& service, int inFd, int outFd) {
+    std::mutex replyMutex;
+    std::condition_variable replyReady;
+    std::deque<std::future<std::string>> replies;
+    bool finished = false;
+
+    std::thread writer([&]() {
+        bool connected = true;
+        while (true) {
+            std::future<std::string> next;
+            {
+                std::unique_lock<std::mutex> lock(replyMutex);
+                replyReady.wait(lock, [&] { return finished || !replies.empty(); });
+                if (replies.empty()) {
+                    return;
                 }
+                next = std::move(replies.front());
+                replies.pop_front();
+            }
+            std::string reply = next.get() + "\n";
+            connected = connected && writeAll(outFd, reply);
+        }
+    });
 
-                if (isBetterPath) {
-                    // Update neighbor node
-                    Node neighbor;
-                    neighbor.x = newX;
-                    neighbor.y = newY;
-                    neighbor.g = tentativeG;
-                    neighbor.h = calculateManhattanDistance(neighbor, end);
-                    neighbor.f = neighbor.g + neighbor.h;
+    auto respond = [&](std::future<std::string> reply) {
+        {
+            std::lock_guard<std::mutex> lock(replyMutex);
+            replies.push_back(std::move(reply));
+        }
+        replyReady.notify_one();
+    };
+    auto respondNow = [&](const std::string& text) {
+        std::promise<std::string> reply;
+        reply.set_value(text);
+        respond(reply.get_future());
+    };
 
-                    openSet.push(neighbor);
+    bool shutdownRequested = false;
+    std::string buffer, line;
+    while (readLine(inFd, buffer, line)) {
+        std::istringstream words(line);
+        std::string command;
+        if (!(words >> command)) {
+            continue;
+        }
 
-                    // Keep track of where the neighbor came from
-                    cameFrom[newY][newX] = current;
-                }
+        if (command == "path") {
+            Node from = { 0, 0, 0, 0, 0 };
+            Node to = { 0, 0, 0, 0, 0 };
+            if (words >> from.x >> from.y >> to.x >> to.y) {
+                respond(service.submit(from, to));
+            }
+            else {
+                respondNow("error usage: path <startX> <startY> <endX> <endY>");
+            }
+        }
+        else if (command == "block" || command == "unblock") {
+            std::vector<CellEdit> edits;
+            CellEdit edit = { 0, 0, command == "block" };
+            while (words >> edit.x >> edit.y) {
+                edits.push_back(edit);
+            }
+            respondNow(edits.empty() ? "error usage: " + command + " <x> <y> [<x> <y> ...]" : service.edit(edits));
+        }
+        else if (command == "stats") {
+            respondNow(service.stats());
+        }
+        else if (command == "reload") {
+            std::vector<std::string> args;
+            std::string word;
+            while (words >> word) {
+                args.push_back(word);
+            }
+            std::vector<char*> argv;
+            for (std::string& arg : args) {
+                argv.push_back(&arg[0]);
             }
+            respondNow(args.empty() ? "error usage: reload <in.map | width height>"
+                                    : service.reload((int)argv.size(), argv.data()));
         }
+        else if (command == "quit") {
+            break;
+        }
+        else if (command == "shutdown") {
+            respondNow("ok shutting down");
+            shutdownRequested = true;
+            break;
+        }
+        else {
+            respondNow("error unknown command " + command);
+        }
+    }
 
-        // Render the grid with the delay
-        SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(gRenderer);
-        renderGrid();
-        SDL_RenderPresent(gRenderer);
+    {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        finished = true;
+    }
+    replyReady.notify_one();
+    writer.join();
+    return shutdownRequested;
+}
 
-        // Delay for visualization
-        SDL_Delay(delayMs);
+// Function to accept connections on a Unix domain socket until a client
+// sends "shutdown"
+int runSocketServer(PathService& service, const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Socket path " << socketPath << " is too long" << std::endl;
+        return 1;
     }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
 
-    // Path not found
-    return false;
+    int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str());
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 64) != 0) {
+        std::cerr << "Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        if (listenFd >= 0) {
+            close(listenFd);
+        }
+        return 1;
+    }
+
+    struct Connection {
+        int fd;
+        std::shared_ptr<std::atomic<bool>> done;
+        std::thread thread;
+    };
+    std::list<Connection> connections;
+    std::atomic<bool> stopping(false);
+
+    while (!stopping) {
+        // Reap connections that have hung up
+        for (std::list<Connection>::iterator it = connections.begin(); it != connections.end();) {
+            if (it->done->load()) {
+                it->thread.join();
+                close(it->fd);
+                it = connections.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        pollfd waiting = { listenFd, POLLIN, 0 };
+        if (poll(&waiting, 1, 200) <= 0) {
+            continue;
+        }
+        int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+        std::shared_ptr<std::atomic<bool>> done(new std::atomic<bool>(false));
+        Connection connection = { fd, done, std::thread([&service, &stopping, fd, done]() {
+            if (serveConnection(service, fd, fd)) {
+                stopping = true;
+            }
+            // Hang up now so the client sees EOF; the fd is closed once reaped
+            shutdown(fd, SHUT_RDWR);
+            done->store(true);
+        }) };
+        connections.push_back(std::move(connection));
+    }
+
+    // Wake any connection still blocked in read, then wait for them
+    for (Connection& connection : connections) {
+        shutdown(connection.fd, SHUT_RD);
+    }
+    for (Connection& connection : connections) {
+        connection.thread.join();
+        close(connection.fd);
+    }
+    close(listenFd);
+    unlink(socketPath.c_str());
+    return 0;
+}
+
+// Function to run the query service: --serve <in.map | width height> [workers] [--socket <path>]
+int runPathService(int argc, char* argv[]) {
+    std::unique_ptr<DenseMap> map;
+    int nextArg = readMapArguments(argc, argv, 2, 10, map);
+    if (nextArg == 0) {
+        return 1;
+    }
+    if (!fitsCompactSearch(*map)) {
+        std::cerr << "Map is too large for the query service" << std::endl;
+        return 1;
+    }
+
+    unsigned workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+    std::string socketPath;
+    for (int i = nextArg; i < argc; i++) {
+        if (std::string(argv[i]) == "--socket" && i + 1 < argc) {
+            socketPath = argv[++i];
+        }
+        else {
+            workerCount = (unsigned)std::max(std::atoi(argv[i]), 1);
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN); // A client hanging up must not kill the service
+    std::cerr << "Serving a " << map->width() << "x" << map->height() << " map with " << workerCount
+              << " workers on " << (socketPath.empty() ? std::string("stdin/stdout") : socketPath) << std::endl;
+
+    PathService service(std::move(map), workerCount);
+    if (!socketPath.empty()) {
+        return runSocketServer(service, socketPath);
+    }
+    serveConnection(service, STDIN_FILENO, STDOUT_FILENO);
+    return 0;
+}
+
+// Function to load a map for the visualizer ("--view <in.map | width height>"),
+// zoomed out to fit the window
+bool loadViewMap(int argc, char* argv[]) {
+    std::unique_ptr<DenseMap> map;
+    if (readMapArguments(argc, argv, 2, 25, map) == 0) {
+        return false;
+    }
+    if (!fitsCompactSearch(*map)) {
+        std::cerr << "Map is too large for the visualizer" << std::endl;
+        return false;
+    }
+
+    mapColumns = map->width();
+    mapRows = map->height();
+    grid = CellArray<uint8_t>(mapColumns, mapRows, 0);
+    for (int y = 0; y < mapRows; y++) {
+        for (int x = 0; x < mapColumns; x++) {
+            if (map->isBlocked(x, y)) {
+                grid[y][x] = 1;
+            }
+        }
+    }
+    screenObstacles.replace(*map);
+    view.zoom(0, 0, 0); // Widest zoom
+    return true;
 }
 
-int main() {
+// Function to run the interactive visualizer on the current map
+int runVisualizer() {
     if (!init()) {
         return 1;
     }
 
+    gridPyramid.build(grid, mapColumns, mapRows);
+    bool largeMap = (uint64_t)mapColumns * mapRows > ANIMATED_MAX_CELLS;
+    FrameScheduler scheduler(largeMap ? 0 : ANIMATION_STEPS_PER_SECOND);
     SDL_Event e;
     bool quit = false;
+    bool redraw = true;
 
     while (!quit) {
-        while (SDL_PollEvent(&e) != 0) {
+        scheduler.beginFrame();
+        bool searching = currentState == INPUT_SEARCHING;
+
+        // Sleep until something happens unless a search is animating or a redraw is due
+        bool haveEvent = searching || redraw ? SDL_PollEvent(&e) != 0 : SDL_WaitEvent(&e) != 0;
+        while (haveEvent) {
             if (e.type == SDL_QUIT) {
                 quit = true;
             }
             else if (e.type == SDL_MOUSEBUTTONDOWN) {
                 handleMouseClick(e);
             }
+            else if (e.type == SDL_MOUSEWHEEL) {
+                // Wheel zooms around the pointer
+                int mouseX, mouseY;
+                SDL_GetMouseState(&mouseX, &mouseY);
+                view.zoom(mouseX, mouseY, std::pow(1.25, e.wheel.y));
+            }
+            else if (e.type == SDL_MOUSEMOTION && (e.motion.state & SDL_BUTTON_RMASK)) {
+                // Right-drag pans
+                view.pan(e.motion.xrel, e.motion.yrel);
+                redraw = true;
+            }
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN) {
                 if (start.x != -1 && end.x != -1 && currentState == INPUT_HURDLES) {
-                    if (aStarWithDelay(50)) { // Delay of 100 milliseconds between iterations
-                        currentState = INPUT_DONE;
-                    }
+                    startAStar();
+                    scheduler.restart();
+                    currentState = INPUT_SEARCHING;
+                }
+            }
+            else if (e.type == SDL_KEYDOWN) {
+                // Animation speed: + faster, - slower, 0 as fast as the frame budget allows
+                int key = e.key.keysym.sym;
+                if (key == SDLK_EQUALS || key == SDLK_PLUS || key == SDLK_KP_PLUS) {
+                    scheduler.faster();
+                }
+                else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                    scheduler.slower();
                 }
+                else if (key == SDLK_0) {
+                    scheduler.unlimited();
+                }
+            }
+            if (e.type != SDL_MOUSEMOTION) {
+                redraw = true;
             }
+            haveEvent = SDL_PollEvent(&e) != 0;
         }
 
-        SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.runSlice(stepAStar);
+            redraw = true;
+        }
 
-        renderGrid();
+        if (redraw) {
+            scheduler.render([]() {
+                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(gRenderer);
+                renderGrid();
+                SDL_RenderPresent(gRenderer);
+            });
+            redraw = false;
+        }
 
-        SDL_RenderPresent(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.endFrame();
+        }
     }
 
+    SDL_DestroyTexture(gViewTexture);
     SDL_DestroyWindow(gWindow);
     SDL_Quit();
     return 0;
 }
+
+// Command line modes for large maps that are searched without the visualizer
+int runCommandLine(int argc, char* argv[]) {
+    std::string mode = argv[1];
+
+    if (mode == "--generate-tiles" && argc >= 5) {
+        uint32_t seed = argc >= 6 ? (uint32_t)std::strtoul(argv[5], nullptr, 10) : 1;
+        bool ok = writeTileStore(argv[2], std::atoi(argv[3]), std::atoi(argv[4]),
+            [seed](int tileX, int tileY, std::vector<uint8_t>& bits) {
+                generateOutdoorTile(seed, tileX, tileY, bits);
+            });
+        return ok ? 0 : 1;
+    }
+
+    if (mode == "--build-tiles" && argc >= 4) {
+        int width, height;
+        std::vector<uint8_t> blocked;
+        if (!loadMovingAIMap(argv[2], width, height, blocked)) {
+            return 1;
+        }
+        bool ok = writeTileStore(argv[3], width, height,
+            [&](int tileX, int tileY, std::vector<uint8_t>& bits) {
+                for (int cy = 0; cy < TILE_SIZE; cy++) {
+                    for (int cx = 0; cx < TILE_SIZE; cx++) {
+                        int x = tileX * TILE_SIZE + cx;
+                        int y = tileY * TILE_SIZE + cy;
+                        if (x < width && y < height && blocked[(size_t)y * width + x]) {
+                            setTileBit(bits.data(), cx, cy);
+                        }
+                    }
+                }
+            });
+        return ok ? 0 : 1;
+    }
+
+    if (mode == "--tiles" && argc >= 7) {
+        size_t maxResident = argc >= 8 ? (size_t)std::strtoul(argv[7], nullptr, 10) : 4096;
+        ChunkedGrid map(maxResident);
+        if (!map.open(argv[2])) {
+            return 1;
+        }
+
+        Node from = { std::atoi(argv[3]), std::atoi(argv[4]), 0, 0, 0 };
+        Node to = { std::atoi(argv[5]), std::atoi(argv[6]), 0, 0, 0 };
+        if (from.x < 0 || from.x >= map.width() || from.y < 0 || from.y >= map.height() ||
+            to.x < 0 || to.x >= map.width() || to.y < 0 || to.y >= map.height()) {
+            std::cerr << "Start and end must lie inside the " << map.width() << "x" << map.height() << " map" << std::endl;
+            return 1;
+        }
+        if (map.isBlocked(from.x, from.y) || map.isBlocked(to.x, to.y)) {
+            std::cerr << "Start and end must be free cells" << std::endl;
+            return 1;
+        }
+
+        SparseSearchState state(map.width());
+        std::vector<Node> path;
+        size_t expanded = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        bool found = aStarSearch(map, state, from, to, path, [&expanded](const Node&) { expanded++; });
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        if (found) {
+            std::cout << "Path length: " << path.size() - 1 << std::endl;
+        }
+        else {
+            std::cout << "No path found" << std::endl;
+        }
+        std::cout << "Expanded nodes: " << expanded << ", cells touched: " << state.size()
+                  << ", time: " << ms << " ms" << std::endl;
+        std::cout << "Tiles paged in: " << map.pageIns() << ", evicted: " << map.evictions()
+                  << ", resident: " << map.residentTiles() << std::endl;
+        return found ? 0 : 2;
+    }
+
+    if (mode == "--view" && argc >= 3) {
+        return loadViewMap(argc, argv) ? runVisualizer() : 1;
+    }
+
+    if (mode == "--bench" && argc >= 3) {
+        return runLayoutBenchmark(argc, argv);
+    }
+
+    if (mode == "--parallel" && argc >= 3) {
+        return runParallelBenchmark(argc, argv);
+    }
+
+    if (mode == "--agents" && argc >= 3) {
+        return runMultiAgent(argc, argv);
+    }
+
+    if (mode == "--serve" && argc >= 3) {
+        return runPathService(argc, argv);
+    }
+
+    std::cerr << "Usage: " << argv[0] << "                                   (interactive visualizer)\n"
+              << "       " << argv[0] << " --view <in.map | width height>        (visualizer on a larger map)\n"
+              << "       " << argv[0] << " --generate-tiles <out.tiles> <width> <height> [seed]\n"
+              << "       " << argv[0] << " --build-tiles <in.map> <out.tiles>\n"
+              << "       " << argv[0] << " --tiles <world.tiles> <startX> <startY> <endX> <endY> [maxResidentTiles]\n"
+              << "       " << argv[0] << " --bench <in.map | width height> [queries] [seed]\n"
+              << "       " << argv[0] << " --parallel <in.map | width height> [maxThreads] [queries] [seed]\n"
+              << "       " << argv[0] << " --agents <in.map | width height> [agents] [window (0 = full)] [threads] [seed]\n"
+              << "       " << argv[0] << " --serve <in.map | width height> [workers] [--socket <path>]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+    return runVisualizer();
+}
@@ -1,7 +1,17 @@
 #include <iostream>
 #include <SDL.h>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <queue>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
 
 const int SCREEN_WIDTH = 600;
 const int SCREEN_HEIGHT = 600;
@@ -13,20 +23,209 @@ struct Node {
     int x, y;
 };
 
+// Cell layout shared by the grid and all per-cell search state, chosen at
+// build time. Row-major by default; -DCELL_LAYOUT_TILED stores 16x16 blocks
+// contiguously and -DCELL_LAYOUT_MORTON lays each of those blocks out in
+// Z-order, so vertical neighbours usually share a cache line or page instead
+// of sitting a full row apart. Both pad the map only to whole blocks.
+const int LAYOUT_BLOCK = 16;
+
+#if defined(CELL_LAYOUT_MORTON)
+const char* const CELL_LAYOUT_NAME = "morton";
+#elif defined(CELL_LAYOUT_TILED)
+const char* const CELL_LAYOUT_NAME = "tiled";
+#else
+const char* const CELL_LAYOUT_NAME = "row-major";
+#endif
+
+// Spreads the low 32 bits of v onto the even bit positions
+inline uint64_t spreadBits(uint64_t v) {
+    v &= 0xFFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+class CellLayout {
+public:
+    CellLayout(int width, int height) : width(width), height(height) {
+        blocksX = (width + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK;
+    }
+
+    size_t index(int x, int y) const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        size_t block = (size_t)((unsigned)y / LAYOUT_BLOCK) * blocksX + (unsigned)x / LAYOUT_BLOCK;
+#endif
+#if defined(CELL_LAYOUT_MORTON)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK +
+               (size_t)(spreadBits((unsigned)x % LAYOUT_BLOCK) | (spreadBits((unsigned)y % LAYOUT_BLOCK) << 1));
+#elif defined(CELL_LAYOUT_TILED)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK + ((unsigned)y % LAYOUT_BLOCK) * LAYOUT_BLOCK + (unsigned)x % LAYOUT_BLOCK;
+#else
+        return (size_t)y * width + x;
+#endif
+    }
+
+    // Number of slots to allocate (the blocked layouts pad the map to whole blocks)
+    size_t size() const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        return (size_t)blocksX * ((height + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK) * LAYOUT_BLOCK * LAYOUT_BLOCK;
+#else
+        return (size_t)width * height;
+#endif
+    }
+
+private:
+    int width, height;
+    int blocksX;
+};
+
+// Per-cell array stored in CellLayout order. Indexed [y][x] like a nested vector.
+template <typename T>
+class CellArray {
+public:
+    typedef typename std::vector<T>::reference Reference;
+    typedef typename std::vector<T>::const_reference ConstReference;
+
+    class Row {
+    public:
+        Row(CellArray& cells, int y) : cells(cells), y(y) {}
+        Reference operator[](int x) { return cells.at(x, y); }
+    private:
+        CellArray& cells;
+        int y;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const CellArray& cells, int y) : cells(cells), y(y) {}
+        ConstReference operator[](int x) const { return cells.at(x, y); }
+    private:
+        const CellArray& cells;
+        int y;
+    };
+
+    CellArray(int width, int height, const T& value) : layout(width, height), cells(layout.size(), value) {}
+
+    Reference at(int x, int y) { return cells[layout.index(x, y)]; }
+    ConstReference at(int x, int y) const { return cells[layout.index(x, y)]; }
+    Row operator[](int y) { return Row(*this, y); }
+    ConstRow operator[](int y) const { return ConstRow(*this, y); }
+
+    void fill(const T& value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    CellLayout layout;
+    std::vector<T> cells;
+};
+
 // SDL window and renderer
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
 
 // Grid representation
-std::vector<std::vector<int>> grid(ROWS, std::vector<int>(COLUMNS, 0));
+CellArray<int> grid(COLUMNS, ROWS, 0);
 
 // Start and end points
 Node start, end;
 
 // State variable to track input order
-enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_DONE };
+enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_SEARCHING, INPUT_DONE };
 InputState currentState = INPUT_START;
 
+// Frame pacing for the visualizer. A running search advances in small steps
+// between frames: each frame gets as many steps as fit the time left after
+// rendering, using running estimates of the step and render cost, optionally
+// capped by an animation speed in steps per second.
+const double TARGET_FRAME_MS = 1000.0 / 60.0;
+const double FRAME_MARGIN_MS = 2.0; // Headroom for event handling and timer jitter
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double stepsPerSecond)
+        : stepsPerSecond(stepsPerSecond), stepCostMs(0.01), renderCostMs(2.0), allowance(0),
+          frameStart(SDL_GetPerformanceCounter()), lastSlice(0) {}
+
+    void beginFrame() { frameStart = SDL_GetPerformanceCounter(); }
+
+    // Runs step() until it returns false, the speed cap is reached or the
+    // frame's time budget is spent. Returns false once the search is over.
+    template <typename Step>
+    bool runSlice(Step step) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        double budgetMs = std::max(TARGET_FRAME_MS - renderCostMs - FRAME_MARGIN_MS, 1.0);
+        double maxSteps = budgetMs / stepCostMs + 1;
+        if (stepsPerSecond > 0) {
+            // Accumulate fractional steps so slow speeds still move every few frames
+            double elapsedMs = lastSlice == 0 ? TARGET_FRAME_MS : millisecondsSince(lastSlice);
+            allowance = std::min(allowance + stepsPerSecond * elapsedMs / 1000.0, stepsPerSecond * TARGET_FRAME_MS / 1000.0 + 1);
+            maxSteps = std::min(maxSteps, allowance);
+        }
+        lastSlice = begin;
+
+        long steps = 0;
+        bool running = true;
+        while (running && steps < (long)maxSteps) {
+            running = step();
+            steps++;
+            // The estimate can be off (e.g. the search hits a slow region), so also check the clock
+            if ((steps & 63) == 0 && millisecondsSince(begin) > budgetMs) {
+                break;
+            }
+        }
+
+        if (steps > 0) {
+            stepCostMs = std::max(0.8 * stepCostMs + 0.2 * millisecondsSince(begin) / steps, 1e-5);
+            allowance -= steps;
+        }
+        return running;
+    }
+
+    template <typename Render>
+    void render(Render draw) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        draw();
+        renderCostMs = 0.8 * renderCostMs + 0.2 * millisecondsSince(begin);
+    }
+
+    // Sleeps off whatever is left of the current frame
+    void endFrame() {
+        double leftMs = TARGET_FRAME_MS - millisecondsSince(frameStart);
+        if (leftMs >= 1) {
+            SDL_Delay((Uint32)leftMs);
+        }
+    }
+
+    // Forgets the speed allowance, e.g. when a new search starts
+    void restart() {
+        allowance = 0;
+        lastSlice = 0;
+    }
+
+    // Speed controls: 0 steps per second means as fast as the frame budget allows
+    void faster() { stepsPerSecond = stepsPerSecond > 0 ? stepsPerSecond * 2 : 0; }
+    void slower() { stepsPerSecond = stepsPerSecond > 0 ? std::max(stepsPerSecond / 2, 1.0) : 1000; }
+    void unlimited() { stepsPerSecond = 0; }
+
+private:
+    static double millisecondsSince(Uint64 start) {
+        return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    double stepsPerSecond;
+    double stepCostMs;
+    double renderCostMs;
+    double allowance;
+    Uint64 frameStart;
+    Uint64 lastSlice;
+};
+
+// Animation speed in search steps per second (one node per 100 ms, as before); 0 means unlimited
+const double ANIMATION_STEPS_PER_SECOND = 10;
+
 // Function to initialize SDL
 bool init() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -107,78 +306,548 @@ void renderGrid() {
     }
 }
 
-// Function to perform Breadth-First Search (BFS)
-// Function to perform Breadth-First Search (BFS) with delay
-bool bfsWithDelay(int delayMs) {
-    std::vector<std::vector<bool>> visited(ROWS, std::vector<bool>(COLUMNS, false));
-    std::vector<std::vector<Node>> parent(ROWS, std::vector<Node>(COLUMNS, { -1, -1 }));
+// Breadth-First Search (BFS) state, kept between frames while it animates
+struct BfsSearch {
+    CellArray<bool> visited;
+    CellArray<Node> parent;
     std::queue<Node> q;
 
+    BfsSearch() : visited(COLUMNS, ROWS, false), parent(COLUMNS, ROWS, { -1, -1 }) {}
+};
+
+std::unique_ptr<BfsSearch> activeSearch;
+
+// Function to start animating Breadth-First Search (BFS) from start to end
+void startBfs() {
+    activeSearch.reset(new BfsSearch());
+
+    // Start BFS from the start node
+    activeSearch->q.push(start);
+    activeSearch->visited[start.y][start.x] = true;
+}
+
+// Function to advance the animated BFS by one node. Returns false once it
+// has finished, after marking the result on the grid.
+bool stepBfs() {
+    BfsSearch& search = *activeSearch;
+
     // Define directions for moving (up, down, left, right)
     int dx[] = {0, 0, -1, 1};
     int dy[] = {-1, 1, 0, 0};
 
-    // Start BFS from the start node
-    q.push(start);
-    visited[start.y][start.x] = true;
-
-    while (!q.empty()) {
-        Node current = q.front();
-        q.pop();
-
-        // Check if we reached the end
-        if (current.x == end.x && current.y == end.y) {
-            // Reconstruct the path
-            int x = end.x;
-            int y = end.y;
-            while (x != -1 && y != -1) {
-                grid[y][x] = 5; // Mark the final path as green
-                Node parentNode = parent[y][x];
-                x = parentNode.x;
-                y = parentNode.y;
-            }
-            grid[start.y][start.x] = 2; // Start in green
-            grid[end.y][end.x] = 3;     // End in red
-            return true;
-        }
-
-        // Explore neighbors (up, down, left, right)
-        for (int i = 0; i < 4; i++) {
-            int newX = current.x + dx[i];
-            int newY = current.y + dy[i];
-
-            // Check if the new position is valid and not visited
-            if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1 && !visited[newY][newX]) {
-                q.push({newX, newY});
-                visited[newY][newX] = true;
-                parent[newY][newX] = current;
-                grid[newY][newX] = 4; // Mark the path
-
-                // Render the grid with the delay
-                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-                SDL_RenderClear(gRenderer);
-                renderGrid();
-                SDL_RenderPresent(gRenderer);
+    if (search.q.empty()) {
+        // Path not found
+        currentState = INPUT_HURDLES;
+        activeSearch.reset();
+        return false;
+    }
+
+    Node current = search.q.front();
+    search.q.pop();
+
+    // Check if we reached the end
+    if (current.x == end.x && current.y == end.y) {
+        // Reconstruct the path
+        int x = end.x;
+        int y = end.y;
+        while (x != -1 && y != -1) {
+            grid[y][x] = 5; // Mark the final path as green
+            Node parentNode = search.parent[y][x];
+            x = parentNode.x;
+            y = parentNode.y;
+        }
+        grid[start.y][start.x] = 2; // Start in green
+        grid[end.y][end.x] = 3;     // End in red
+        currentState = INPUT_DONE;
+        activeSearch.reset();
+        return false;
+    }
+
+    // Explore neighbors (up, down, left, right)
+    for (int i = 0; i < 4; i++) {
+        int newX = current.x + dx[i];
+        int newY = current.y + dy[i];
+
+        // Check if the new position is valid and not visited
+        if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1 && !search.visited[newY][newX]) {
+            search.q.push({newX, newY});
+            search.visited[newY][newX] = true;
+            search.parent[newY][newX] = current;
+            grid[newY][newX] = 4; // Mark the path
+        }
+    }
+    return true;
+}
+
+// Compressed path database (CPD) ------------------------------------------
+//
+// An offline table of optimal first moves: for every free source cell, the
+// move (an index into the BFS direction tables) that starts a shortest path
+// to every free target. Each source's row is run-length encoded over the
+// free cells in Z-order, where nearby targets usually share a first move.
+// Where several first moves are optimal the encoder picks whichever extends
+// the current run. Queries then need no search at all: the next move is a
+// binary search in one row, and a whole path is a walk of next moves.
+//
+// File layout: CpdHeader, then uint32 rank[width * height] (each cell's
+// position in Z-order among free cells, CPD_BLOCKED for blocked cells),
+// uint32 component[freeCells] (connected component of each ranked cell),
+// uint64 runOffset[freeCells + 1] and uint32 runs[runCount], each run being
+// (rank of its first target << 2) | move.
+const uint32_t CPD_MAGIC = 0x31445043; // "CPD1"
+const uint32_t CPD_BLOCKED = 0xFFFFFFFF;
+
+// Lowest move index set in a bitmask of moves
+inline uint32_t lowestMove(uint8_t moves) {
+    uint32_t move = 0;
+    while (move < 3 && !(moves & (1 << move))) {
+        move++;
+    }
+    return move;
+}
+
+struct CpdHeader {
+    uint32_t magic;
+    int32_t width;
+    int32_t height;
+    uint32_t freeCells;
+    uint64_t runCount;
+};
+
+// Dense map for the database builder
+struct GridMap {
+    int width, height;
+    std::vector<uint8_t> blocked; // Row-major
+
+    bool isBlocked(int x, int y) const { return blocked[(size_t)y * width + x] != 0; }
+};
+
+// Function to load a map in the MovingAI benchmark format ("type", "height",
+// "width" and "map" header lines, then one text row per grid row). '.', 'G'
+// and 'S' are passable, everything else is blocked.
+bool loadMovingAIMap(const std::string& path, GridMap& map) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        std::cerr << "Could not open map " << path << std::endl;
+        return false;
+    }
+
+    std::string word;
+    map.width = map.height = 0;
+    while (in >> word && word != "map") {
+        if (word == "height") {
+            in >> map.height;
+        }
+        else if (word == "width") {
+            in >> map.width;
+        }
+    }
+    if (map.width <= 0 || map.height <= 0) {
+        std::cerr << "Map " << path << " has no valid size header" << std::endl;
+        return false;
+    }
+
+    map.blocked.assign((size_t)map.width * map.height, 1);
+    std::string row;
+    for (int y = 0; y < map.height && in >> row; y++) {
+        for (int x = 0; x < map.width && x < (int)row.size(); x++) {
+            char c = row[x];
+            map.blocked[(size_t)y * map.width + x] = (c == '.' || c == 'G' || c == 'S') ? 0 : 1;
+        }
+    }
+    return true;
+}
+
+// Function to read "<in.map> | <width> <height>" arguments at argv[first]
+// (generated maps block a fifth of the cells at random). Returns the index of
+// the first argument after the map, or 0 on error.
+int readMapArguments(int argc, char* argv[], int first, GridMap& map) {
+    if (first >= argc) {
+        return 0;
+    }
+    if (argc >= first + 2 && std::atoi(argv[first]) > 0 && std::atoi(argv[first + 1]) > 0) {
+        map.width = std::atoi(argv[first]);
+        map.height = std::atoi(argv[first + 1]);
+        std::mt19937 rng((uint32_t)map.width * 31 + map.height);
+        map.blocked.resize((size_t)map.width * map.height);
+        for (size_t i = 0; i < map.blocked.size(); i++) {
+            map.blocked[i] = rng() % 5 == 0 ? 1 : 0;
+        }
+        return first + 2;
+    }
+    return loadMovingAIMap(argv[first], map) ? first + 1 : 0;
+}
+
+// Runs work(i) for every i in [begin, end) on up to threadCount threads
+template <typename Work>
+void parallelFor(size_t begin, size_t end, unsigned threadCount, Work work) {
+    std::atomic<size_t> next(begin);
+    auto run = [&]() {
+        for (size_t i = next++; i < end; i = next++) {
+            work(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount && t < end - begin; t++) {
+        threads.push_back(std::thread(run));
+    }
+    run();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
+
+// Function to build a path database for a map and write it to outPath
+bool buildPathDatabase(const GridMap& map, const std::string& outPath, unsigned threadCount) {
+    // Define directions for moving (up, down, left, right)
+    const int dx[] = {0, 0, -1, 1};
+    const int dy[] = {-1, 1, 0, 0};
+    const size_t cellCount = (size_t)map.width * map.height;
+
+    // Order free cells along the Z-order curve
+    std::vector<std::pair<uint64_t, uint32_t>> order;
+    for (int y = 0; y < map.height; y++) {
+        for (int x = 0; x < map.width; x++) {
+            if (!map.isBlocked(x, y)) {
+                order.push_back(std::make_pair(spreadBits((uint32_t)x) | (spreadBits((uint32_t)y) << 1),
+                                               (uint32_t)y * map.width + x));
+            }
+        }
+    }
+    std::sort(order.begin(), order.end());
+    const uint32_t freeCells = (uint32_t)order.size();
+    if ((uint64_t)freeCells >= (1u << 30)) {
+        std::cerr << "Map has too many free cells for a path database" << std::endl;
+        return false;
+    }
+
+    std::vector<uint32_t> rank(cellCount, CPD_BLOCKED);
+    for (uint32_t r = 0; r < freeCells; r++) {
+        rank[order[r].second] = r;
+    }
 
-                // Delay for visualization
-                SDL_Delay(delayMs);
+    // Connected components, so lookups can reject unreachable targets
+    std::vector<uint32_t> component(freeCells, CPD_BLOCKED);
+    uint32_t components = 0;
+    for (uint32_t r = 0; r < freeCells; r++) {
+        if (component[r] != CPD_BLOCKED) {
+            continue;
+        }
+        std::queue<uint32_t> q;
+        q.push(order[r].second);
+        component[r] = components;
+        while (!q.empty()) {
+            uint32_t cell = q.front();
+            q.pop();
+            int x = (int)(cell % map.width);
+            int y = (int)(cell / map.width);
+            for (int i = 0; i < 4; i++) {
+                int newX = x + dx[i];
+                int newY = y + dy[i];
+                if (newX >= 0 && newX < map.width && newY >= 0 && newY < map.height && !map.isBlocked(newX, newY)) {
+                    uint32_t neighbor = (uint32_t)newY * map.width + newX;
+                    if (component[rank[neighbor]] == CPD_BLOCKED) {
+                        component[rank[neighbor]] = components;
+                        q.push(neighbor);
+                    }
+                }
             }
         }
+        components++;
+    }
+
+    // One BFS sweep per source. Each target gets the set of optimal first
+    // moves as a bitmask: the union over its predecessors on shortest paths.
+    std::vector<std::vector<uint32_t>> runsBySource(freeCells);
+    std::atomic<uint32_t> finishedSources(0);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    parallelFor(0, freeCells, threadCount, [&](size_t source) {
+        std::vector<uint32_t> distance(cellCount, CPD_BLOCKED);
+        std::vector<uint8_t> moves(cellCount, 0);
+        std::vector<uint32_t> q;
+        q.reserve(freeCells);
+
+        uint32_t sourceCell = order[source].second;
+        distance[sourceCell] = 0;
+        q.push_back(sourceCell);
+        for (size_t head = 0; head < q.size(); head++) {
+            uint32_t cell = q[head];
+            int x = (int)(cell % map.width);
+            int y = (int)(cell / map.width);
+            for (int i = 0; i < 4; i++) {
+                int newX = x + dx[i];
+                int newY = y + dy[i];
+                if (newX < 0 || newX >= map.width || newY < 0 || newY >= map.height || map.isBlocked(newX, newY)) {
+                    continue;
+                }
+                uint32_t neighbor = (uint32_t)newY * map.width + newX;
+                uint8_t viaHere = cell == sourceCell ? (uint8_t)(1 << i) : moves[cell];
+                if (distance[neighbor] == CPD_BLOCKED) {
+                    distance[neighbor] = distance[cell] + 1;
+                    moves[neighbor] = viaHere;
+                    q.push_back(neighbor);
+                }
+                else if (distance[neighbor] == distance[cell] + 1) {
+                    moves[neighbor] |= viaHere;
+                }
+            }
+        }
+
+        // Greedy run-length encoding: grow each run while some move is
+        // optimal for all of its targets. The source itself and unreachable
+        // targets accept any move.
+        std::vector<uint32_t>& runs = runsBySource[source];
+        uint8_t candidates = 0xF;
+        uint32_t runStart = 0;
+        for (uint32_t target = 0; target < freeCells; target++) {
+            uint32_t cell = order[target].second;
+            uint8_t allowed = (cell == sourceCell || distance[cell] == CPD_BLOCKED) ? 0xF : moves[cell];
+            if ((candidates & allowed) == 0) {
+                runs.push_back(runStart << 2 | lowestMove(candidates));
+                runStart = target;
+                candidates = allowed;
+            }
+            else {
+                candidates &= allowed;
+            }
+        }
+        runs.push_back(runStart << 2 | lowestMove(candidates));
+        runs.shrink_to_fit();
+
+        uint32_t done = ++finishedSources;
+        if (done % 4096 == 0) {
+            std::cerr << "\r" << done << "/" << freeCells << " sources" << std::flush;
+        }
+    });
+
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+    std::vector<uint64_t> runOffset(freeCells + 1, 0);
+    for (uint32_t r = 0; r < freeCells; r++) {
+        runOffset[r + 1] = runOffset[r] + runsBySource[r].size();
+    }
+
+    std::ofstream out(outPath.c_str(), std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Could not create " << outPath << std::endl;
+        return false;
+    }
+    CpdHeader header = { CPD_MAGIC, map.width, map.height, freeCells, runOffset[freeCells] };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(rank.data()), rank.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(component.data()), component.size() * sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(runOffset.data()), runOffset.size() * sizeof(uint64_t));
+    for (const std::vector<uint32_t>& runs : runsBySource) {
+        out.write(reinterpret_cast<const char*>(runs.data()), runs.size() * sizeof(uint32_t));
+    }
+    if (!out.good()) {
+        std::cerr << "Could not write " << outPath << std::endl;
+        return false;
     }
 
-    return false;
+    std::cerr << "\r" << freeCells << " sources swept in " << buildSeconds << " s with " << threadCount
+              << " threads; " << header.runCount << " runs (" << (double)header.runCount / std::max(freeCells, 1u)
+              << " per source), " << (uint64_t)out.tellp() / (1024.0 * 1024.0) << " MB" << std::endl;
+    return true;
 }
 
-int main() {
+// Reads a path database and answers first-move and path queries from it
+class PathDatabase {
+public:
+    bool load(const std::string& path) {
+        std::ifstream in(path.c_str(), std::ios::binary);
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CPD_MAGIC ||
+            header.width <= 0 || header.height <= 0) {
+            std::cerr << "Could not read path database " << path << std::endl;
+            return false;
+        }
+
+        rank.resize((size_t)header.width * header.height);
+        component.resize(header.freeCells);
+        runOffset.resize((size_t)header.freeCells + 1);
+        runs.resize(header.runCount);
+        in.read(reinterpret_cast<char*>(rank.data()), rank.size() * sizeof(uint32_t));
+        in.read(reinterpret_cast<char*>(component.data()), component.size() * sizeof(uint32_t));
+        in.read(reinterpret_cast<char*>(runOffset.data()), runOffset.size() * sizeof(uint64_t));
+        in.read(reinterpret_cast<char*>(runs.data()), runs.size() * sizeof(uint32_t));
+        if (!in) {
+            std::cerr << "Path database " << path << " is truncated" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    int width() const { return header.width; }
+    int height() const { return header.height; }
+
+    // Returns the first move (an index into the BFS direction tables) of a
+    // shortest path, or -1 if the cells are equal, blocked or not connected
+    int firstMove(int fromX, int fromY, int toX, int toY) const {
+        uint32_t source = rankOf(fromX, fromY);
+        uint32_t target = rankOf(toX, toY);
+        if (source == CPD_BLOCKED || target == CPD_BLOCKED || source == target ||
+            component[source] != component[target]) {
+            return -1;
+        }
+
+        // The run covering the target is the last one starting at or before it
+        const uint32_t* first = runs.data() + runOffset[source];
+        const uint32_t* last = runs.data() + runOffset[source + 1];
+        const uint32_t* run = std::upper_bound(first, last, (target << 2) | 3) - 1;
+        return (int)(*run & 3);
+    }
+
+    // Extracts a whole shortest path (start and end inclusive) by following
+    // first moves. Returns false if there is none.
+    bool extractPath(const Node& from, const Node& to, std::vector<Node>& path) const {
+        const int dx[] = {0, 0, -1, 1};
+        const int dy[] = {-1, 1, 0, 0};
+
+        path.clear();
+        uint32_t source = rankOf(from.x, from.y);
+        uint32_t target = rankOf(to.x, to.y);
+        if (source == CPD_BLOCKED || target == CPD_BLOCKED || component[source] != component[target]) {
+            return false;
+        }
+
+        Node current = from;
+        path.push_back(current);
+        while ((current.x != to.x || current.y != to.y) && path.size() <= header.freeCells) {
+            int move = firstMove(current.x, current.y, to.x, to.y);
+            current.x += dx[move];
+            current.y += dy[move];
+            path.push_back(current);
+        }
+        return current.x == to.x && current.y == to.y;
+    }
+
+    bool isFree(int x, int y) const { return rankOf(x, y) != CPD_BLOCKED; }
+    size_t runCount() const { return runs.size(); }
+
+private:
+    uint32_t rankOf(int x, int y) const {
+        if (x < 0 || x >= header.width || y < 0 || y >= header.height) {
+            return CPD_BLOCKED;
+        }
+        return rank[(size_t)y * header.width + x];
+    }
+
+    CpdHeader header;
+    std::vector<uint32_t> rank;
+    std::vector<uint32_t> component;
+    std::vector<uint64_t> runOffset;
+    std::vector<uint32_t> runs;
+};
+
+// Command line modes for the path database; the visualizer runs without arguments
+int runCommandLine(int argc, char* argv[]) {
+    std::string mode = argv[1];
+
+    if (mode == "--build-cpd" && argc >= 4) {
+        GridMap map;
+        int nextArg = readMapArguments(argc, argv, 2, map);
+        if (nextArg == 0 || nextArg >= argc) {
+            return 1;
+        }
+        unsigned threadCount = argc > nextArg + 1 ? (unsigned)std::atoi(argv[nextArg + 1])
+                                                  : std::thread::hardware_concurrency();
+        return buildPathDatabase(map, argv[nextArg], std::max(threadCount, 1u)) ? 0 : 1;
+    }
+
+    if (mode == "--cpd-path" && argc >= 7) {
+        PathDatabase database;
+        if (!database.load(argv[2])) {
+            return 1;
+        }
+        Node from = { std::atoi(argv[3]), std::atoi(argv[4]) };
+        Node to = { std::atoi(argv[5]), std::atoi(argv[6]) };
+        std::vector<Node> path;
+        if (!database.extractPath(from, to, path)) {
+            std::cout << "No path found" << std::endl;
+            return 2;
+        }
+        std::cout << "Path length: " << path.size() - 1 << std::endl;
+        for (const Node& step : path) {
+            std::cout << step.x << "," << step.y << " ";
+        }
+        std::cout << std::endl;
+        return 0;
+    }
+
+    if (mode == "--cpd-bench" && argc >= 3) {
+        PathDatabase database;
+        if (!database.load(argv[2])) {
+            return 1;
+        }
+        int queries = argc >= 4 ? std::atoi(argv[3]) : 10000;
+
+        // Draw endpoints from the free cells directly, so sparse maps cannot stall
+        std::vector<Node> freeCells;
+        for (int y = 0; y < database.height(); y++) {
+            for (int x = 0; x < database.width(); x++) {
+                if (database.isFree(x, y)) {
+                    freeCells.push_back({ x, y });
+                }
+            }
+        }
+        if (freeCells.empty()) {
+            std::cerr << "Path database " << argv[2] << " has no free cells" << std::endl;
+            return 1;
+        }
+
+        std::mt19937 rng(1);
+        std::vector<std::pair<Node, Node>> endpoints;
+        while ((int)endpoints.size() < queries) {
+            const Node& from = freeCells[rng() % freeCells.size()];
+            const Node& to = freeCells[rng() % freeCells.size()];
+            endpoints.push_back(std::make_pair(from, to));
+        }
+
+        std::vector<Node> path;
+        size_t moves = 0;
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (const std::pair<Node, Node>& query : endpoints) {
+            if (database.extractPath(query.first, query.second, path)) {
+                moves += path.size() - 1;
+            }
+        }
+        double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << endpoints.size() << " paths, " << moves << " moves in " << us / 1000.0 << " ms: "
+                  << us / std::max<size_t>(endpoints.size(), 1) << " us per path, "
+                  << 1000.0 * us / std::max<size_t>(moves, 1) << " ns per move" << std::endl;
+        return 0;
+    }
+
+    std::cerr << "Usage: " << argv[0] << "                                   (interactive visualizer)\n"
+              << "       " << argv[0] << " --build-cpd <in.map | width height> <out.cpd> [threads]\n"
+              << "       " << argv[0] << " --cpd-path <db.cpd> <startX> <startY> <endX> <endY>\n"
+              << "       " << argv[0] << " --cpd-bench <db.cpd> [queries]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+
     if (!init()) {
         return 1;
     }
 
+    FrameScheduler scheduler(ANIMATION_STEPS_PER_SECOND);
     SDL_Event e;
     bool quit = false;
+    bool redraw = true;
 
     while (!quit) {
-        while (SDL_PollEvent(&e) != 0) {
+        scheduler.beginFrame();
+        bool searching = currentState == INPUT_SEARCHING;
+
+        // Sleep until something happens unless a search is animating or a redraw is due
+        bool haveEvent = searching || redraw ? SDL_PollEvent(&e) != 0 : SDL_WaitEvent(&e) != 0;
+        while (haveEvent) {
             if (e.type == SDL_QUIT) {
                 quit = true;
             }
@@ -187,19 +856,48 @@ int main() {
             }
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN) {
                 if (start.x != -1 && end.x != -1 && currentState == INPUT_HURDLES) {
-                    if (bfsWithDelay(100)) { // Delay of 100 milliseconds between iterations
-                        currentState = INPUT_DONE;
-                    }
+                    startBfs();
+                    scheduler.restart();
+                    currentState = INPUT_SEARCHING;
+                }
+            }
+            else if (e.type == SDL_KEYDOWN) {
+                // Animation speed: + faster, - slower, 0 as fast as the frame budget allows
+                int key = e.key.keysym.sym;
+                if (key == SDLK_EQUALS || key == SDLK_PLUS || key == SDLK_KP_PLUS) {
+                    scheduler.faster();
+                }
+                else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                    scheduler.slower();
+                }
+                else if (key == SDLK_0) {
+                    scheduler.unlimited();
                 }
             }
+            if (e.type != SDL_MOUSEMOTION) {
+                redraw = true;
+            }
+            haveEvent = SDL_PollEvent(&e) != 0;
         }
 
-        SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.runSlice(stepBfs);
+            redraw = true;
+        }
 
-        renderGrid();
+        if (redraw) {
+            scheduler.render([]() {
+                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(gRenderer);
+                renderGrid();
+                SDL_RenderPresent(gRenderer);
+            });
+            redraw = false;
+        }
 
-        SDL_RenderPresent(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.endFrame();
+        }
     }
 
     SDL_DestroyWindow(gWindow);
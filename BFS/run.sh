@@ -1,7 +1,8 @@
 set -u -e
 
 # Compile it and output to executable called 'app'
-g++ -std=c++11 -g bfs.cpp -I/Library/Frameworks/SDL2.framework/Headers -F/Library/Frameworks -framework SDL2 -o app
+# (set CXXFLAGS=-DCELL_LAYOUT_TILED or -DCELL_LAYOUT_MORTON to change the cell layout)
+g++ -std=c++11 -g -pthread ${CXXFLAGS:-} bfs.cpp -I/Library/Frameworks/SDL2.framework/Headers -F/Library/Frameworks -framework SDL2 -o app
 # runs the app
- ./app
+ ./app "$@"
 
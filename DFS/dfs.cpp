@@ -1,7 +1,11 @@
 #include <iostream>
 #include <SDL.h>
 #include <vector>
-#include <stack>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <climits>
+#include <cstdlib>
 
 const int SCREEN_WIDTH = 600;
 const int SCREEN_HEIGHT = 600;
@@ -13,20 +17,209 @@ struct Node {
     int x, y;
 };
 
+// Cell layout shared by the grid and all per-cell search state, chosen at
+// build time. Row-major by default; -DCELL_LAYOUT_TILED stores 16x16 blocks
+// contiguously and -DCELL_LAYOUT_MORTON lays each of those blocks out in
+// Z-order, so vertical neighbours usually share a cache line or page instead
+// of sitting a full row apart. Both pad the map only to whole blocks.
+const int LAYOUT_BLOCK = 16;
+
+#if defined(CELL_LAYOUT_MORTON)
+const char* const CELL_LAYOUT_NAME = "morton";
+#elif defined(CELL_LAYOUT_TILED)
+const char* const CELL_LAYOUT_NAME = "tiled";
+#else
+const char* const CELL_LAYOUT_NAME = "row-major";
+#endif
+
+// Spreads the low 32 bits of v onto the even bit positions
+inline uint64_t spreadBits(uint64_t v) {
+    v &= 0xFFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+class CellLayout {
+public:
+    CellLayout(int width, int height) : width(width), height(height) {
+        blocksX = (width + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK;
+    }
+
+    size_t index(int x, int y) const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        size_t block = (size_t)((unsigned)y / LAYOUT_BLOCK) * blocksX + (unsigned)x / LAYOUT_BLOCK;
+#endif
+#if defined(CELL_LAYOUT_MORTON)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK +
+               (size_t)(spreadBits((unsigned)x % LAYOUT_BLOCK) | (spreadBits((unsigned)y % LAYOUT_BLOCK) << 1));
+#elif defined(CELL_LAYOUT_TILED)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK + ((unsigned)y % LAYOUT_BLOCK) * LAYOUT_BLOCK + (unsigned)x % LAYOUT_BLOCK;
+#else
+        return (size_t)y * width + x;
+#endif
+    }
+
+    // Number of slots to allocate (the blocked layouts pad the map to whole blocks)
+    size_t size() const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        return (size_t)blocksX * ((height + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK) * LAYOUT_BLOCK * LAYOUT_BLOCK;
+#else
+        return (size_t)width * height;
+#endif
+    }
+
+private:
+    int width, height;
+    int blocksX;
+};
+
+// Per-cell array stored in CellLayout order. Indexed [y][x] like a nested vector.
+template <typename T>
+class CellArray {
+public:
+    typedef typename std::vector<T>::reference Reference;
+    typedef typename std::vector<T>::const_reference ConstReference;
+
+    class Row {
+    public:
+        Row(CellArray& cells, int y) : cells(cells), y(y) {}
+        Reference operator[](int x) { return cells.at(x, y); }
+    private:
+        CellArray& cells;
+        int y;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const CellArray& cells, int y) : cells(cells), y(y) {}
+        ConstReference operator[](int x) const { return cells.at(x, y); }
+    private:
+        const CellArray& cells;
+        int y;
+    };
+
+    CellArray(int width, int height, const T& value) : layout(width, height), cells(layout.size(), value) {}
+
+    Reference at(int x, int y) { return cells[layout.index(x, y)]; }
+    ConstReference at(int x, int y) const { return cells[layout.index(x, y)]; }
+    Row operator[](int y) { return Row(*this, y); }
+    ConstRow operator[](int y) const { return ConstRow(*this, y); }
+
+    void fill(const T& value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    CellLayout layout;
+    std::vector<T> cells;
+};
+
 // SDL window and renderer
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
 
 // Grid representation
-std::vector<std::vector<int>> grid(ROWS, std::vector<int>(COLUMNS, 0));
+CellArray<int> grid(COLUMNS, ROWS, 0);
 
 // Start and end points
 Node start, end;
 
 // State variable to track input order
-enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_DONE };
+enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_SEARCHING, INPUT_DONE };
 InputState currentState = INPUT_START;
 
+// Frame pacing for the visualizer. A running search advances in small steps
+// between frames: each frame gets as many steps as fit the time left after
+// rendering, using running estimates of the step and render cost, optionally
+// capped by an animation speed in steps per second.
+const double TARGET_FRAME_MS = 1000.0 / 60.0;
+const double FRAME_MARGIN_MS = 2.0; // Headroom for event handling and timer jitter
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double stepsPerSecond)
+        : stepsPerSecond(stepsPerSecond), stepCostMs(0.01), renderCostMs(2.0), allowance(0),
+          frameStart(SDL_GetPerformanceCounter()), lastSlice(0) {}
+
+    void beginFrame() { frameStart = SDL_GetPerformanceCounter(); }
+
+    // Runs step() until it returns false, the speed cap is reached or the
+    // frame's time budget is spent. Returns false once the search is over.
+    template <typename Step>
+    bool runSlice(Step step) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        double budgetMs = std::max(TARGET_FRAME_MS - renderCostMs - FRAME_MARGIN_MS, 1.0);
+        double maxSteps = budgetMs / stepCostMs + 1;
+        if (stepsPerSecond > 0) {
+            // Accumulate fractional steps so slow speeds still move every few frames
+            double elapsedMs = lastSlice == 0 ? TARGET_FRAME_MS : millisecondsSince(lastSlice);
+            allowance = std::min(allowance + stepsPerSecond * elapsedMs / 1000.0, stepsPerSecond * TARGET_FRAME_MS / 1000.0 + 1);
+            maxSteps = std::min(maxSteps, allowance);
+        }
+        lastSlice = begin;
+
+        long steps = 0;
+        bool running = true;
+        while (running && steps < (long)maxSteps) {
+            running = step();
+            steps++;
+            // The estimate can be off (e.g. the search hits a slow region), so also check the clock
+            if ((steps & 63) == 0 && millisecondsSince(begin) > budgetMs) {
+                break;
+            }
+        }
+
+        if (steps > 0) {
+            stepCostMs = std::max(0.8 * stepCostMs + 0.2 * millisecondsSince(begin) / steps, 1e-5);
+            allowance -= steps;
+        }
+        return running;
+    }
+
+    template <typename Render>
+    void render(Render draw) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        draw();
+        renderCostMs = 0.8 * renderCostMs + 0.2 * millisecondsSince(begin);
+    }
+
+    // Sleeps off whatever is left of the current frame
+    void endFrame() {
+        double leftMs = TARGET_FRAME_MS - millisecondsSince(frameStart);
+        if (leftMs >= 1) {
+            SDL_Delay((Uint32)leftMs);
+        }
+    }
+
+    // Forgets the speed allowance, e.g. when a new search starts
+    void restart() {
+        allowance = 0;
+        lastSlice = 0;
+    }
+
+    // Speed controls: 0 steps per second means as fast as the frame budget allows
+    void faster() { stepsPerSecond = stepsPerSecond > 0 ? stepsPerSecond * 2 : 0; }
+    void slower() { stepsPerSecond = stepsPerSecond > 0 ? std::max(stepsPerSecond / 2, 1.0) : 1000; }
+    void unlimited() { stepsPerSecond = 0; }
+
+private:
+    static double millisecondsSince(Uint64 start) {
+        return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    double stepsPerSecond;
+    double stepCostMs;
+    double renderCostMs;
+    double allowance;
+    Uint64 frameStart;
+    Uint64 lastSlice;
+};
+
+// Animation speed in search steps per second (one node per 100 ms, as before); 0 means unlimited
+const double ANIMATION_STEPS_PER_SECOND = 10;
+
 // Function to initialize SDL
 bool init() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -107,67 +300,299 @@ void renderGrid() {
     }
 }
 
-bool depthFirstSearchWithDelay(int delayMs) {
-    std::vector<std::vector<bool>> visited(ROWS, std::vector<bool>(COLUMNS, false));
-    std::stack<Node> stack;
+// Neighbour offsets, tried in this order from every cell
+const int DX[] = { -1, 1, 0, 0 };
+const int DY[] = { 0, 0, -1, 1 };
+
+// One level of the current depth-first path: a cell, the cost of reaching it
+// (used by IDA*) and the next direction to try from it. The frames from the
+// bottom up are the path from the start, so no parent table is needed.
+struct SearchFrame {
+    Node cell;
+    int g;
+    int nextDirection;
+};
+
+// Depth-First Search state, kept between frames while it animates. Cells are
+// marked visited when they are pushed, so each is pushed at most once and the
+// stack never grows past the length of the current path.
+struct DepthFirstSearch {
+    CellArray<bool> visited; // One bit per cell
+    std::vector<SearchFrame> frames;
+
+    DepthFirstSearch() : visited(COLUMNS, ROWS, false) {}
+};
+
+std::unique_ptr<DepthFirstSearch> activeSearch;
+
+// Function to mark a path held in search frames on the grid
+void markPath(const std::vector<SearchFrame>& frames) {
+    for (const SearchFrame& frame : frames) {
+        grid[frame.cell.y][frame.cell.x] = 5; // Mark the final path as green
+    }
+    grid[start.y][start.x] = 2; // Start in green
+    grid[end.y][end.x] = 3;     // End in red
+}
 
-    // Create a 2D array to keep track of the parent node for each cell
-    std::vector<std::vector<Node>> parent(ROWS, std::vector<Node>(COLUMNS, { -1, -1 }));
+// Function to start animating Depth-First Search from start to end
+void startDepthFirstSearch() {
+    activeSearch.reset(new DepthFirstSearch());
+    activeSearch->visited[start.y][start.x] = true;
+    activeSearch->frames.push_back({ start, 0, 0 });
+}
 
-    stack.push(start);
+// Function to advance the animated DFS by one move: onto the next unvisited
+// neighbour, or back one cell from a dead end. Returns false once it has
+// finished, after marking the result on the grid.
+bool stepDepthFirstSearch() {
+    DepthFirstSearch& search = *activeSearch;
 
-    while (!stack.empty()) {
-        Node current = stack.top();
-        stack.pop();
+    if (search.frames.empty()) {
+        // Path not found
+        currentState = INPUT_HURDLES;
+        activeSearch.reset();
+        return false;
+    }
 
-        int x = current.x;
-        int y = current.y;
+    SearchFrame& top = search.frames.back();
+    if (top.cell.x == end.x && top.cell.y == end.y) {
+        // Reached the end; the frames are the path
+        markPath(search.frames);
+        currentState = INPUT_DONE;
+        activeSearch.reset();
+        return false;
+    }
 
-        if (x == end.x && y == end.y) {
-            // Reached the end, reconstruct the path
-            while (x != -1 && y != -1) {
-                grid[y][x] = 5; // Mark the final path as green
+    while (top.nextDirection < 4) {
+        int newX = top.cell.x + DX[top.nextDirection];
+        int newY = top.cell.y + DY[top.nextDirection];
+        top.nextDirection++;
 
-                // Move to the parent node
-                Node parentNode = parent[y][x];
-                x = parentNode.x;
-                y = parentNode.y;
+        // Check if the neighbor is within bounds
+        if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1 && !search.visited[newY][newX]) {
+            search.visited[newY][newX] = true;
+            if (grid[newY][newX] == 0) {
+                grid[newY][newX] = 4; // Mark visited nodes as yellow
             }
-            grid[start.y][start.x] = 2; // Start in green
-            grid[end.y][end.x] = 3;     // End in red
+            search.frames.push_back({ { newX, newY }, 0, 0 });
             return true;
         }
+    }
 
-        visited[y][x] = true;
-        grid[y][x] = 4; // Mark visited nodes as yellow
+    // Dead end, back up
+    search.frames.pop_back();
+    return true;
+}
 
-        // Generate neighbors
-        int dx[] = { -1, 1, 0, 0 };
-        int dy[] = { 0, 0, -1, 1 };
+// IDA*: repeated depth-first passes with a rising bound on f = g + h
+// (Manhattan distance). Each pass explores every path whose f stays within
+// the bound and takes the smallest f beyond it as the next bound, so the
+// first path found is a shortest one. Memory is the current path, plus an
+// optional fixed-size transposition table.
+//
+// The table holds, per cell and pass, the cheapest g the cell was reached
+// at within the bound, or the smallest f it was cut off at if it has not
+// been reached. Arrivals no cheaper than a recorded one are skipped, and only
+// cells that were never reached count toward the next bound. That way the
+// passes stop once every reachable cell fits, even when the end is
+// unreachable. Cut-offs pushed out by a colliding cell are kept in a running
+// minimum, so collisions can only lower the next bound. Without the table,
+// or if collisions keep it low, no shortest path is longer than the cell
+// count, so the search gives up there.
+const int IDA_TABLE_BITS = 16; // 65536 entries, 1 MB
+
+struct TranspositionEntry {
+    uint32_t cell;
+    uint32_t bound; // Pass the entry belongs to; older entries are ignored
+    uint32_t g;     // Cheapest cost the cell was reached at, UINT32_MAX if only cut off
+    uint32_t cutF;  // Smallest f the cell was cut off at
+};
 
-        for (int i = 0; i < 4; i++) {
-            int newX = x + dx[i];
-            int newY = y + dy[i];
+class TranspositionTable {
+public:
+    TranspositionTable() : entries(1 << IDA_TABLE_BITS, { UINT32_MAX, UINT32_MAX, 0, 0 }), lostCut(UINT32_MAX) {}
 
-            // Check if the neighbor is within bounds
-            if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1 && !visited[newY][newX]) {
-                stack.push({ newX, newY });
-                parent[newY][newX] = { x, y }; // Set the parent of the neighbor
+    // Whether the cell was already reached at cost g or less during this pass
+    bool seen(uint32_t cell, uint32_t g, uint32_t bound) const {
+        const TranspositionEntry& entry = entries[slot(cell)];
+        return entry.cell == cell && entry.bound == bound && entry.g <= g;
+    }
 
-                // Render the grid with the delay
-                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-                SDL_RenderClear(gRenderer);
-                renderGrid();
-                SDL_RenderPresent(gRenderer);
+    void reached(uint32_t cell, uint32_t g, uint32_t bound) {
+        claim(cell, bound).g = g;
+    }
 
-                // Delay for visualization
-                SDL_Delay(delayMs);
+    void cutOff(uint32_t cell, uint32_t f, uint32_t bound) {
+        TranspositionEntry& entry = claim(cell, bound);
+        if (entry.g == UINT32_MAX) {
+            entry.cutF = std::min(entry.cutF, f);
+        }
+    }
+
+    // Smallest f cut off during this pass at a cell the pass never reached,
+    // or INT_MAX if there was none
+    int nextBound(uint32_t bound) const {
+        uint32_t next = lostCut;
+        for (const TranspositionEntry& entry : entries) {
+            if (entry.bound == bound && entry.g == UINT32_MAX) {
+                next = std::min(next, entry.cutF);
             }
         }
+        return next == UINT32_MAX ? INT_MAX : (int)next;
     }
 
-    // Path not found
-    return false;
+    void beginPass() { lostCut = UINT32_MAX; }
+
+private:
+    static size_t slot(uint32_t cell) { return (cell * 2654435761u) >> (32 - IDA_TABLE_BITS); }
+
+    // Entry for the cell in this pass, evicting whatever held the slot
+    TranspositionEntry& claim(uint32_t cell, uint32_t bound) {
+        TranspositionEntry& entry = entries[slot(cell)];
+        if (entry.cell != cell || entry.bound != bound) {
+            if (entry.bound == bound && entry.g == UINT32_MAX) {
+                lostCut = std::min(lostCut, entry.cutF);
+            }
+            entry = { cell, bound, UINT32_MAX, UINT32_MAX };
+        }
+        return entry;
+    }
+
+    std::vector<TranspositionEntry> entries;
+    uint32_t lostCut;
+};
+
+struct IdaStarSearch {
+    std::vector<SearchFrame> frames;
+    int bound;     // f limit of the current pass
+    int nextBound; // Smallest f that went over it
+    int passes;
+    size_t expanded;
+    size_t peakFrames;
+    std::unique_ptr<TranspositionTable> table;
+};
+
+std::unique_ptr<IdaStarSearch> activeIdaStar;
+bool useTranspositionTable = true; // Toggled with T
+
+int manhattanToEnd(int x, int y) {
+    return std::abs(x - end.x) + std::abs(y - end.y);
+}
+
+// Function to begin an IDA* pass with the current bound
+void beginIdaStarPass(IdaStarSearch& search) {
+    // Clear the marks of the previous pass
+    for (int y = 0; y < ROWS; y++) {
+        for (int x = 0; x < COLUMNS; x++) {
+            if (grid[y][x] == 4) {
+                grid[y][x] = 0;
+            }
+        }
+    }
+
+    search.passes++;
+    search.nextBound = INT_MAX;
+    search.frames.push_back({ start, 0, 0 });
+    if (search.table) {
+        search.table->beginPass();
+        search.table->reached((uint32_t)(start.y * COLUMNS + start.x), 0, (uint32_t)search.bound);
+    }
+}
+
+// Function to start animating IDA* from start to end
+void startIdaStar() {
+    activeIdaStar.reset(new IdaStarSearch());
+    IdaStarSearch& search = *activeIdaStar;
+    search.bound = manhattanToEnd(start.x, start.y);
+    search.passes = 0;
+    search.expanded = 0;
+    search.peakFrames = 0;
+    if (useTranspositionTable) {
+        search.table.reset(new TranspositionTable());
+    }
+    beginIdaStarPass(search);
+}
+
+// Function to advance the animated IDA* by one move, like DFS. Returns false
+// once it has finished, after marking the result on the grid.
+bool stepIdaStar() {
+    IdaStarSearch& search = *activeIdaStar;
+
+    if (search.frames.empty()) {
+        if (search.table) {
+            search.nextBound = search.table->nextBound((uint32_t)search.bound);
+        }
+        if (search.nextBound == INT_MAX || search.nextBound >= ROWS * COLUMNS) {
+            // Every reachable cell fit in the bound, or only paths longer than any shortest one are left
+            std::cout << "IDA*: no path after " << search.passes << " passes" << std::endl;
+            currentState = INPUT_HURDLES;
+            activeIdaStar.reset();
+            return false;
+        }
+        search.bound = search.nextBound;
+        beginIdaStarPass(search);
+        return true;
+    }
+
+    SearchFrame& top = search.frames.back();
+    if (top.cell.x == end.x && top.cell.y == end.y) {
+        std::cout << "IDA*: path length " << top.g << " after " << search.passes << " passes, "
+                  << search.expanded << " expansions, at most " << search.peakFrames << " frames"
+                  << (search.table ? " with" : " without") << " transposition table" << std::endl;
+        markPath(search.frames);
+        currentState = INPUT_DONE;
+        activeIdaStar.reset();
+        return false;
+    }
+
+    while (top.nextDirection < 4) {
+        int newX = top.cell.x + DX[top.nextDirection];
+        int newY = top.cell.y + DY[top.nextDirection];
+        top.nextDirection++;
+
+        if (newX < 0 || newX >= COLUMNS || newY < 0 || newY >= ROWS || grid[newY][newX] == 1) {
+            continue;
+        }
+
+        // Never step straight back to the parent
+        size_t depth = search.frames.size();
+        if (depth >= 2 && search.frames[depth - 2].cell.x == newX && search.frames[depth - 2].cell.y == newY) {
+            continue;
+        }
+
+        // A cell already reached as cheaply this pass has nothing new to offer
+        int g = top.g + 1;
+        uint32_t cell = (uint32_t)(newY * COLUMNS + newX);
+        if (search.table && search.table->seen(cell, (uint32_t)g, (uint32_t)search.bound)) {
+            continue;
+        }
+
+        int f = g + manhattanToEnd(newX, newY);
+        if (f > search.bound) {
+            if (search.table) {
+                search.table->cutOff(cell, (uint32_t)f, (uint32_t)search.bound);
+            }
+            else {
+                search.nextBound = std::min(search.nextBound, f);
+            }
+            continue;
+        }
+        if (search.table) {
+            search.table->reached(cell, (uint32_t)g, (uint32_t)search.bound);
+        }
+
+        if (grid[newY][newX] == 0) {
+            grid[newY][newX] = 4; // Mark visited nodes as yellow
+        }
+        search.frames.push_back({ { newX, newY }, g, 0 });
+        search.expanded++;
+        search.peakFrames = std::max(search.peakFrames, search.frames.size());
+        return true;
+    }
+
+    // Every direction tried, back up
+    search.frames.pop_back();
+    return true;
 }
 
 int main() {
@@ -175,11 +600,18 @@ int main() {
         return 1;
     }
 
+    FrameScheduler scheduler(ANIMATION_STEPS_PER_SECOND);
     SDL_Event e;
     bool quit = false;
+    bool redraw = true;
 
     while (!quit) {
-        while (SDL_PollEvent(&e) != 0) {
+        scheduler.beginFrame();
+        bool searching = currentState == INPUT_SEARCHING;
+
+        // Sleep until something happens unless a search is animating or a redraw is due
+        bool haveEvent = searching || redraw ? SDL_PollEvent(&e) != 0 : SDL_WaitEvent(&e) != 0;
+        while (haveEvent) {
             if (e.type == SDL_QUIT) {
                 quit = true;
             }
@@ -188,19 +620,60 @@ int main() {
             }
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN) {
                 if (start.x != -1 && end.x != -1 && currentState == INPUT_HURDLES) {
-                    if (depthFirstSearchWithDelay(100)) { // Delay of 100 milliseconds between iterations
-                        currentState = INPUT_DONE;
-                    }
+                    startDepthFirstSearch();
+                    scheduler.restart();
+                    currentState = INPUT_SEARCHING;
+                }
+            }
+            else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_i) {
+                // I runs IDA* instead of DFS
+                if (start.x != -1 && end.x != -1 && currentState == INPUT_HURDLES) {
+                    startIdaStar();
+                    scheduler.restart();
+                    currentState = INPUT_SEARCHING;
+                }
+            }
+            else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_t) {
+                useTranspositionTable = !useTranspositionTable;
+                std::cout << "IDA* transposition table " << (useTranspositionTable ? "on" : "off") << std::endl;
+            }
+            else if (e.type == SDL_KEYDOWN) {
+                // Animation speed: + faster, - slower, 0 as fast as the frame budget allows
+                int key = e.key.keysym.sym;
+                if (key == SDLK_EQUALS || key == SDLK_PLUS || key == SDLK_KP_PLUS) {
+                    scheduler.faster();
+                }
+                else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                    scheduler.slower();
                 }
+                else if (key == SDLK_0) {
+                    scheduler.unlimited();
+                }
+            }
+            if (e.type != SDL_MOUSEMOTION) {
+                redraw = true;
             }
+            haveEvent = SDL_PollEvent(&e) != 0;
         }
 
-        SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.runSlice(activeIdaStar ? stepIdaStar : stepDepthFirstSearch);
+            redraw = true;
+        }
 
-        renderGrid();
+        if (redraw) {
+            scheduler.render([]() {
+                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(gRenderer);
+                renderGrid();
+                SDL_RenderPresent(gRenderer);
+            });
+            redraw = false;
+        }
 
-        SDL_RenderPresent(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.endFrame();
+        }
     }
 
     SDL_DestroyWindow(gWindow);
@@ -1,6 +1,9 @@
 #include <iostream>
 #include <SDL.h>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <queue>
 
 const int SCREEN_WIDTH = 600;
@@ -19,20 +22,209 @@ struct Node {
     }
 };
 
+// Cell layout shared by the grid and all per-cell search state, chosen at
+// build time. Row-major by default; -DCELL_LAYOUT_TILED stores 16x16 blocks
+// contiguously and -DCELL_LAYOUT_MORTON lays each of those blocks out in
+// Z-order, so vertical neighbours usually share a cache line or page instead
+// of sitting a full row apart. Both pad the map only to whole blocks.
+const int LAYOUT_BLOCK = 16;
+
+#if defined(CELL_LAYOUT_MORTON)
+const char* const CELL_LAYOUT_NAME = "morton";
+#elif defined(CELL_LAYOUT_TILED)
+const char* const CELL_LAYOUT_NAME = "tiled";
+#else
+const char* const CELL_LAYOUT_NAME = "row-major";
+#endif
+
+// Spreads the low 32 bits of v onto the even bit positions
+inline uint64_t spreadBits(uint64_t v) {
+    v &= 0xFFFFFFFFull;
+    v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+    v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+    v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    v = (v | (v << 2)) & 0x3333333333333333ull;
+    v = (v | (v << 1)) & 0x5555555555555555ull;
+    return v;
+}
+
+class CellLayout {
+public:
+    CellLayout(int width, int height) : width(width), height(height) {
+        blocksX = (width + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK;
+    }
+
+    size_t index(int x, int y) const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        size_t block = (size_t)((unsigned)y / LAYOUT_BLOCK) * blocksX + (unsigned)x / LAYOUT_BLOCK;
+#endif
+#if defined(CELL_LAYOUT_MORTON)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK +
+               (size_t)(spreadBits((unsigned)x % LAYOUT_BLOCK) | (spreadBits((unsigned)y % LAYOUT_BLOCK) << 1));
+#elif defined(CELL_LAYOUT_TILED)
+        return block * LAYOUT_BLOCK * LAYOUT_BLOCK + ((unsigned)y % LAYOUT_BLOCK) * LAYOUT_BLOCK + (unsigned)x % LAYOUT_BLOCK;
+#else
+        return (size_t)y * width + x;
+#endif
+    }
+
+    // Number of slots to allocate (the blocked layouts pad the map to whole blocks)
+    size_t size() const {
+#if defined(CELL_LAYOUT_MORTON) || defined(CELL_LAYOUT_TILED)
+        return (size_t)blocksX * ((height + LAYOUT_BLOCK - 1) / LAYOUT_BLOCK) * LAYOUT_BLOCK * LAYOUT_BLOCK;
+#else
+        return (size_t)width * height;
+#endif
+    }
+
+private:
+    int width, height;
+    int blocksX;
+};
+
+// Per-cell array stored in CellLayout order. Indexed [y][x] like a nested vector.
+template <typename T>
+class CellArray {
+public:
+    typedef typename std::vector<T>::reference Reference;
+    typedef typename std::vector<T>::const_reference ConstReference;
+
+    class Row {
+    public:
+        Row(CellArray& cells, int y) : cells(cells), y(y) {}
+        Reference operator[](int x) { return cells.at(x, y); }
+    private:
+        CellArray& cells;
+        int y;
+    };
+
+    class ConstRow {
+    public:
+        ConstRow(const CellArray& cells, int y) : cells(cells), y(y) {}
+        ConstReference operator[](int x) const { return cells.at(x, y); }
+    private:
+        const CellArray& cells;
+        int y;
+    };
+
+    CellArray(int width, int height, const T& value) : layout(width, height), cells(layout.size(), value) {}
+
+    Reference at(int x, int y) { return cells[layout.index(x, y)]; }
+    ConstReference at(int x, int y) const { return cells[layout.index(x, y)]; }
+    Row operator[](int y) { return Row(*this, y); }
+    ConstRow operator[](int y) const { return ConstRow(*this, y); }
+
+    void fill(const T& value) { std::fill(cells.begin(), cells.end(), value); }
+
+private:
+    CellLayout layout;
+    std::vector<T> cells;
+};
+
 // SDL window and renderer
 SDL_Window* gWindow = nullptr;
 SDL_Renderer* gRenderer = nullptr;
 
 // Grid representation
-std::vector<std::vector<int>> grid(ROWS, std::vector<int>(COLUMNS, 0));
+CellArray<int> grid(COLUMNS, ROWS, 0);
 
 // Start and end points
 Node start, end;
 
 // State variable to track input order
-enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_DONE };
+enum InputState { INPUT_START, INPUT_END, INPUT_HURDLES, INPUT_SEARCHING, INPUT_DONE };
 InputState currentState = INPUT_START;
 
+// Frame pacing for the visualizer. A running search advances in small steps
+// between frames: each frame gets as many steps as fit the time left after
+// rendering, using running estimates of the step and render cost, optionally
+// capped by an animation speed in steps per second.
+const double TARGET_FRAME_MS = 1000.0 / 60.0;
+const double FRAME_MARGIN_MS = 2.0; // Headroom for event handling and timer jitter
+
+class FrameScheduler {
+public:
+    explicit FrameScheduler(double stepsPerSecond)
+        : stepsPerSecond(stepsPerSecond), stepCostMs(0.01), renderCostMs(2.0), allowance(0),
+          frameStart(SDL_GetPerformanceCounter()), lastSlice(0) {}
+
+    void beginFrame() { frameStart = SDL_GetPerformanceCounter(); }
+
+    // Runs step() until it returns false, the speed cap is reached or the
+    // frame's time budget is spent. Returns false once the search is over.
+    template <typename Step>
+    bool runSlice(Step step) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        double budgetMs = std::max(TARGET_FRAME_MS - renderCostMs - FRAME_MARGIN_MS, 1.0);
+        double maxSteps = budgetMs / stepCostMs + 1;
+        if (stepsPerSecond > 0) {
+            // Accumulate fractional steps so slow speeds still move every few frames
+            double elapsedMs = lastSlice == 0 ? TARGET_FRAME_MS : millisecondsSince(lastSlice);
+            allowance = std::min(allowance + stepsPerSecond * elapsedMs / 1000.0, stepsPerSecond * TARGET_FRAME_MS / 1000.0 + 1);
+            maxSteps = std::min(maxSteps, allowance);
+        }
+        lastSlice = begin;
+
+        long steps = 0;
+        bool running = true;
+        while (running && steps < (long)maxSteps) {
+            running = step();
+            steps++;
+            // The estimate can be off (e.g. the search hits a slow region), so also check the clock
+            if ((steps & 63) == 0 && millisecondsSince(begin) > budgetMs) {
+                break;
+            }
+        }
+
+        if (steps > 0) {
+            stepCostMs = std::max(0.8 * stepCostMs + 0.2 * millisecondsSince(begin) / steps, 1e-5);
+            allowance -= steps;
+        }
+        return running;
+    }
+
+    template <typename Render>
+    void render(Render draw) {
+        Uint64 begin = SDL_GetPerformanceCounter();
+        draw();
+        renderCostMs = 0.8 * renderCostMs + 0.2 * millisecondsSince(begin);
+    }
+
+    // Sleeps off whatever is left of the current frame
+    void endFrame() {
+        double leftMs = TARGET_FRAME_MS - millisecondsSince(frameStart);
+        if (leftMs >= 1) {
+            SDL_Delay((Uint32)leftMs);
+        }
+    }
+
+    // Forgets the speed allowance, e.g. when a new search starts
+    void restart() {
+        allowance = 0;
+        lastSlice = 0;
+    }
+
+    // Speed controls: 0 steps per second means as fast as the frame budget allows
+    void faster() { stepsPerSecond = stepsPerSecond > 0 ? stepsPerSecond * 2 : 0; }
+    void slower() { stepsPerSecond = stepsPerSecond > 0 ? std::max(stepsPerSecond / 2, 1.0) : 1000; }
+    void unlimited() { stepsPerSecond = 0; }
+
+private:
+    static double millisecondsSince(Uint64 start) {
+        return (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    }
+
+    double stepsPerSecond;
+    double stepCostMs;
+    double renderCostMs;
+    double allowance;
+    Uint64 frameStart;
+    Uint64 lastSlice;
+};
+
+// Animation speed in search steps per second (it previously ran with no delay); 0 means unlimited
+const double ANIMATION_STEPS_PER_SECOND = 0;
+
 // Function to initialize SDL
 bool init() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -116,63 +308,27 @@ int manhattanDistance(const Node& a, const Node& b) {
     return abs(a.x - b.x) + abs(a.y - b.y);
 }
 
-// Function to perform Dijkstra's algorithm with a specified delay
-void dijkstraWithDelay(int delayMilliseconds) {
-    std::vector<std::vector<int>> distance(ROWS, std::vector<int>(COLUMNS, INT_MAX));
-    std::vector<std::vector<std::pair<int, int>>> parent(ROWS, std::vector<std::pair<int, int>>(COLUMNS, { -1, -1 }));
+// Dijkstra's algorithm state, kept between frames while it animates
+struct DijkstraSearch {
+    CellArray<int> distance;
+    CellArray<std::pair<int, int>> parent;
     std::priority_queue<std::pair<int, Node>> pq;
 
-    distance[start.y][start.x] = 0;
-    pq.push({ 0, start });
-
-    bool foundEnd = false; // Flag to check if we've found the end node
-
-    while (!pq.empty()) {
-        Node current = pq.top().second;
-        pq.pop();
-
-        int x = current.x;
-        int y = current.y;
-        int dist = current.distance;
-
-        // If we've reached the end, set the flag
-        if (x == end.x && y == end.y) {
-            foundEnd = true;
-        }
-
-        // Visit neighbors (up, down, left, right)
-        int dx[] = { -1, 1, 0, 0 };
-        int dy[] = { 0, 0, -1, 1 };
-
-        for (int i = 0; i < 4; i++) {
-            int newX = x + dx[i];
-            int newY = y + dy[i];
-
-            if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1) {
-                int newDist = dist + manhattanDistance({ newX, newY }, end); // Manhattan distance as weight
-
-                if (newDist < distance[newY][newX]) {
-                    distance[newY][newX] = newDist;
-                    parent[newY][newX] = { x, y };
-                    pq.push({ -newDist, { newX, newY, newDist } });
+    DijkstraSearch() : distance(COLUMNS, ROWS, INT_MAX), parent(COLUMNS, ROWS, { -1, -1 }) {}
+};
 
-                    // Delay for visualization
-                    SDL_Delay(delayMilliseconds);
+std::unique_ptr<DijkstraSearch> activeSearch;
 
-                    // Render the grid after the delay
-                    SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-                    SDL_RenderClear(gRenderer);
-                    renderGrid();
-                    SDL_RenderPresent(gRenderer);
-                }
-            }
-        }
+// Function to start animating Dijkstra's algorithm from start to end
+void startDijkstra() {
+    activeSearch.reset(new DijkstraSearch());
+    activeSearch->distance[start.y][start.x] = 0;
+    activeSearch->pq.push({ 0, start });
+}
 
-        // If we've found the end node, break the loop
-        if (foundEnd) {
-            break;
-        }
-    }
+// Function to mark the finished search on the grid
+void finishDijkstra(bool foundEnd) {
+    DijkstraSearch& search = *activeSearch;
 
     // Mark visited nodes (excluding the final path) as yellow
     for (int i = 0; i < ROWS; i++) {
@@ -180,35 +336,89 @@ void dijkstraWithDelay(int delayMilliseconds) {
             if (grid[i][j] == 4) {
                 grid[i][j] = 0; // Reset the color for previously marked path nodes
             }
-            if (grid[i][j] == 0 && distance[i][j] != INT_MAX) {
+            if (grid[i][j] == 0 && search.distance[i][j] != INT_MAX) {
                 grid[i][j] = 4; // Mark visited nodes as yellow
             }
         }
     }
 
+    // Reconstruct the final path and mark it as green
     int x = end.x;
     int y = end.y;
-
-    // Reconstruct the final path and mark it as green
-    while (x != start.x || y != start.y) {
+    while (foundEnd && (x != start.x || y != start.y)) {
         grid[y][x] = 5; // Mark the path as green
-        int newX = parent[y][x].first;
-        int newY = parent[y][x].second;
+        int newX = search.parent[y][x].first;
+        int newY = search.parent[y][x].second;
         x = newX;
         y = newY;
     }
 }
 
+// Function to advance the animated Dijkstra's algorithm by one node. Returns
+// false once it has finished, after marking the result on the grid.
+bool stepDijkstra() {
+    DijkstraSearch& search = *activeSearch;
+
+    if (search.pq.empty()) {
+        finishDijkstra(false);
+        currentState = INPUT_DONE;
+        activeSearch.reset();
+        return false;
+    }
+
+    Node current = search.pq.top().second;
+    search.pq.pop();
+
+    int x = current.x;
+    int y = current.y;
+    int dist = current.distance;
+
+    // Visit neighbors (up, down, left, right)
+    int dx[] = { -1, 1, 0, 0 };
+    int dy[] = { 0, 0, -1, 1 };
+
+    for (int i = 0; i < 4; i++) {
+        int newX = x + dx[i];
+        int newY = y + dy[i];
+
+        if (newX >= 0 && newX < COLUMNS && newY >= 0 && newY < ROWS && grid[newY][newX] != 1) {
+            int newDist = dist + manhattanDistance({ newX, newY }, end); // Manhattan distance as weight
+
+            if (newDist < search.distance[newY][newX]) {
+                search.distance[newY][newX] = newDist;
+                search.parent[newY][newX] = { x, y };
+                search.pq.push({ -newDist, { newX, newY, newDist } });
+            }
+        }
+    }
+
+    // If we've reached the end, stop after relaxing its neighbours as before
+    if (x == end.x && y == end.y) {
+        finishDijkstra(true);
+        currentState = INPUT_DONE;
+        activeSearch.reset();
+        return false;
+    }
+    return true;
+}
+
 int main() {
     if (!init()) {
         return 1;
     }
 
+    FrameScheduler scheduler(ANIMATION_STEPS_PER_SECOND);
     SDL_Event e;
     bool quit = false;
+    bool redraw = true;
 
     while (!quit) {
-        while (SDL_PollEvent(&e) != 0) {
+        scheduler.beginFrame();
+        bool searching = currentState == INPUT_SEARCHING;
+
+        // Sleep until something happens unless a search is animating or a redraw is due
+        bool haveEvent = searching || redraw ? SDL_PollEvent(&e) != 0 : SDL_WaitEvent(&e) != 0;
+        while (haveEvent) {
             if (e.type == SDL_QUIT) {
                 quit = true;
             }
@@ -217,18 +427,48 @@ int main() {
             }
             else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_RETURN) {
                 if (start.x != -1 && end.x != -1 && currentState == INPUT_HURDLES) {
-                    dijkstraWithDelay(0); // You can adjust the delay here
-                    currentState = INPUT_DONE;
+                    startDijkstra();
+                    scheduler.restart();
+                    currentState = INPUT_SEARCHING;
+                }
+            }
+            else if (e.type == SDL_KEYDOWN) {
+                // Animation speed: + faster, - slower, 0 as fast as the frame budget allows
+                int key = e.key.keysym.sym;
+                if (key == SDLK_EQUALS || key == SDLK_PLUS || key == SDLK_KP_PLUS) {
+                    scheduler.faster();
+                }
+                else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                    scheduler.slower();
+                }
+                else if (key == SDLK_0) {
+                    scheduler.unlimited();
                 }
             }
+            if (e.type != SDL_MOUSEMOTION) {
+                redraw = true;
+            }
+            haveEvent = SDL_PollEvent(&e) != 0;
         }
 
-        SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
-        SDL_RenderClear(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.runSlice(stepDijkstra);
+            redraw = true;
+        }
 
-        renderGrid();
+        if (redraw) {
+            scheduler.render([]() {
+                SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 255);
+                SDL_RenderClear(gRenderer);
+                renderGrid();
+                SDL_RenderPresent(gRenderer);
+            });
+            redraw = false;
+        }
 
-        SDL_RenderPresent(gRenderer);
+        if (currentState == INPUT_SEARCHING) {
+            scheduler.endFrame();
+        }
     }
 
     SDL_DestroyWindow(gWindow);